@@ -0,0 +1,631 @@
+/**
+ * @file benchmark.c
+ * @brief Mede o desempenho dos modos do compressor sobre corpora gerados.
+ *
+ * Para cada corpus (aleatório, enviesado, texto, inteiros de 16 bits e um só byte) e cada modo
+ * (canônico, ordem 1, blocos, blocos em quatro fluxos, 16 bits e adaptativo), compacta e descompacta em memória, confere o resultado e grava uma linha
+ * com a taxa de compactação, o peso do cabeçalho, a velocidade (MB/s, a melhor de várias
+ * repetições) e o pico de memória. A saída é CSV (padrão) ou JSON, para comparar versões.
+ *
+ * Compilação: gcc -O2 benchmark.c -o benchmark -lpthread
+ *
+ * No POSIX, cada caso roda em um processo filho e o pico de memória (ru_maxrss) é só dele; no
+ * Windows os casos rodam no próprio processo e o pico não é medido (-1).
+ */
+
+#include "bibliotecas/canonico.h"
+#include "bibliotecas/contexto.h"
+#include "bibliotecas/memoria.h"
+#include "bibliotecas/adaptativo.h"
+#include "bibliotecas/largo.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+/**
+ * @def TAM_CORPUS_PADRAO
+ * @brief Tamanho padrão de cada corpus, em MiB.
+ */
+#define TAM_CORPUS_PADRAO 16
+
+/**
+ * @def REPETICOES_PADRAO
+ * @brief Quantidade padrão de repetições de cada medida (vale a mais rápida).
+ */
+#define REPETICOES_PADRAO 3
+
+/**
+ * @def N_INTEIROS
+ * @brief Quantidade de valores distintos do corpus de inteiros de 16 bits.
+ */
+#define N_INTEIROS 4096
+
+/**
+ * @def N_PALAVRAS
+ * @brief Tamanho do vocabulário do corpus de texto.
+ */
+#define N_PALAVRAS 512
+
+/**
+ * @struct RESULTADO
+ * @brief Medidas de um modo sobre um corpus.
+ *
+ * - corpus, modo: nomes do corpus e do modo.
+ * - tam_original, tam_compactado, tam_cabecalho: tamanhos em bytes.
+ * - mb_compactar, mb_descompactar: velocidade, em MB/s dos dados originais.
+ * - memoria_kb: pico de memória do processo, em KiB (-1 se não medido).
+ * - ok: indica que a descompactação devolveu os dados originais.
+ */
+typedef struct{
+    const char *corpus;
+    const char *modo;
+    size_t tam_original;
+    size_t tam_compactado;
+    size_t tam_cabecalho;
+    double mb_compactar;
+    double mb_descompactar;
+    long memoria_kb;
+    int ok;
+}RESULTADO;
+
+/**
+ * @struct MODO
+ * @brief Um modo de compactação medido pelo benchmark.
+ *
+ * - compactar: compacta em memória e informa o tamanho do cabeçalho; retorna o tamanho compactado ou -1.
+ * - descompactar: descompacta em memória; retorna o tamanho original ou -1.
+ */
+typedef struct{
+    const char *nome;
+    long long (*compactar)(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade, size_t *tam_cabecalho);
+    long long (*descompactar)(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade);
+}MODO;
+
+/**
+ * @brief Retorna um relógio monotônico, em segundos.
+ *
+ * @return double Segundos desde um instante fixo.
+ */
+double agora(){
+#ifdef _WIN32
+    LARGE_INTEGER contador, frequencia;
+    QueryPerformanceCounter(&contador);
+    QueryPerformanceFrequency(&frequencia);
+    return (double)contador.QuadPart / (double)frequencia.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+#endif
+}
+
+/**
+ * @brief Gerador pseudoaleatório xorshift64, para os corpora serem iguais em todas as execuções.
+ *
+ * @param estado Ponteiro para o estado do gerador (diferente de zero).
+ * @return unsigned long long Próximo número.
+ */
+static inline unsigned long long sortear(unsigned long long *estado){
+    *estado ^= *estado << 13;
+    *estado ^= *estado >> 7;
+    *estado ^= *estado << 17;
+    return *estado;
+}
+
+/**
+ * @brief Monta a distribuição acumulada de Zipf (peso 1/(i+1)) com n valores, em escala de 2^32.
+ *
+ * @param acumulada Vetor de n posições a ser preenchido.
+ * @param n Quantidade de valores.
+ */
+void montar_zipf(unsigned long long *acumulada, int n){
+    double total = 0, soma = 0;
+    for(int i = 0; i < n; i++)
+        total += 1.0 / (i + 1);
+    for(int i = 0; i < n; i++){
+        soma += 1.0 / (i + 1);
+        acumulada[i] = (unsigned long long)(soma / total * 4294967296.0);
+    }
+    acumulada[n - 1] = 4294967296ULL;
+}
+
+/**
+ * @brief Sorteia um valor da distribuição acumulada (busca binária).
+ *
+ * @param acumulada Distribuição acumulada, em escala de 2^32.
+ * @param n Quantidade de valores.
+ * @param estado Ponteiro para o estado do gerador.
+ * @return int Valor sorteado, de 0 a n - 1.
+ */
+int sortear_zipf(const unsigned long long *acumulada, int n, unsigned long long *estado){
+    unsigned long long alvo = sortear(estado) >> 32;
+    int inicio = 0, fim = n - 1;
+    while(inicio < fim){
+        int meio = (inicio + fim) / 2;
+        if(acumulada[meio] > alvo) fim = meio;
+        else inicio = meio + 1;
+    }
+    return inicio;
+}
+
+/**
+ * @brief Preenche um corpus de texto: palavras de um vocabulário fixo, escolhidas com frequência de
+ * Zipf, separadas por espaços, com pontuação e quebras de linha.
+ *
+ * @param dados Região a ser preenchida.
+ * @param tamanho Tamanho da região.
+ * @param estado Ponteiro para o estado do gerador.
+ */
+void gerar_texto(unsigned char *dados, size_t tamanho, unsigned long long *estado){
+    static const char *silabas[] = {"de", "ca", "men", "to", "ra", "que", "se", "pro", "da", "li",
+                                    "na", "ção", "mo", "ver", "ta", "por", "um", "e", "o", "a",
+                                    "con", "es", "tra", "ni", "vo", "lha", "pa", "sa", "ri", "do"};
+    int n_silabas = sizeof(silabas) / sizeof(silabas[0]);
+    char palavras[N_PALAVRAS][32];
+    unsigned long long acumulada[N_PALAVRAS];
+
+    for(int i = 0; i < N_PALAVRAS; i++){
+        int partes = 1 + sortear(estado) % 4;
+        palavras[i][0] = '\0';
+        for(int k = 0; k < partes; k++)
+            strcat(palavras[i], silabas[sortear(estado) % n_silabas]);
+    }
+    montar_zipf(acumulada, N_PALAVRAS);
+
+    size_t posicao = 0;
+    int na_linha = 0, inicio_frase = 1;
+    while(posicao < tamanho){
+        const char *palavra = palavras[sortear_zipf(acumulada, N_PALAVRAS, estado)];
+        for(size_t k = 0; palavra[k] && posicao < tamanho; k++){
+            char c = palavra[k];
+            if(inicio_frase && k == 0 && c >= 'a' && c <= 'z') c -= 'a' - 'A';
+            dados[posicao++] = c;
+        }
+        inicio_frase = 0;
+
+        unsigned long long sorteio = sortear(estado) % 100;
+        const char *separador = " ";
+        if(sorteio < 6){ separador = ". "; inicio_frase = 1; }
+        else if(sorteio < 12) separador = ", ";
+
+        if(++na_linha == 12){
+            separador = sorteio < 12 ? ".\n" : "\n";
+            inicio_frase = sorteio < 12;
+            na_linha = 0;
+        }
+        for(size_t k = 0; separador[k] && posicao < tamanho; k++)
+            dados[posicao++] = separador[k];
+    }
+}
+
+/**
+ * @brief Preenche um corpus.
+ *
+ * @param nome Nome do corpus: "aleatorio", "enviesado", "texto", "inteiros16" ou "um_byte".
+ * @param dados Região a ser preenchida.
+ * @param tamanho Tamanho da região.
+ */
+void gerar_corpus(const char *nome, unsigned char *dados, size_t tamanho){
+    unsigned long long estado = 0x9E3779B97F4A7C15ULL;
+
+    if(strcmp(nome, "aleatorio") == 0){
+        for(size_t i = 0; i < tamanho; i++)
+            dados[i] = sortear(&estado) >> 56;
+    }else if(strcmp(nome, "enviesado") == 0){
+        unsigned long long acumulada[TAM_ASCII];
+        montar_zipf(acumulada, TAM_ASCII);
+        for(size_t i = 0; i < tamanho; i++)
+            dados[i] = sortear_zipf(acumulada, TAM_ASCII, &estado);
+    }else if(strcmp(nome, "texto") == 0){
+        gerar_texto(dados, tamanho, &estado);
+    }else if(strcmp(nome, "inteiros16") == 0){
+        // Uma coluna de inteiros de 16 bits (little-endian), com frequência de Zipf entre N_INTEIROS valores espalhados
+        static unsigned long long acumulada[N_INTEIROS];
+        montar_zipf(acumulada, N_INTEIROS);
+        for(size_t i = 0; i + 1 < tamanho; i += 2){
+            unsigned int valor = (sortear_zipf(acumulada, N_INTEIROS, &estado) * 40503u) & 0xFFFF;
+            dados[i] = valor;
+            dados[i + 1] = valor >> 8;
+        }
+        if(tamanho % 2) dados[tamanho - 1] = 0;
+    }else{
+        memset(dados, 'a', tamanho);
+    }
+}
+
+/**
+ * @brief Modo canônico: um cabeçalho com os tamanhos dos códigos e os dados.
+ */
+long long compactar_canonico_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade, size_t *tam_cabecalho){
+    unsigned long frequencia[TAM_ASCII] = {0};
+    histograma(origem, tam_origem, frequencia);
+
+    LEITOR leitor;
+    ESCRITOR escritor;
+    iniciar_leitor_memoria(&leitor, origem, tam_origem);
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+
+    long cabecalho = codificar_canonico_leitor(&leitor, &escritor, frequencia, tam_origem, 0);
+    if(cabecalho < 0) return -1;
+    *tam_cabecalho = cabecalho;
+    return escritor.tamanho;
+}
+
+long long descompactar_canonico_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade){
+    if(tam_origem < 3) return -1;
+
+    LEITOR leitor;
+    ESCRITOR escritor;
+    iniciar_leitor_memoria(&leitor, origem + 3, tam_origem - 3);
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+
+    return decodificar_canonico_leitor(&leitor, &escritor, tam_origem) ? (long long)escritor.tamanho : -1;
+}
+
+/**
+ * @brief Modo de ordem 1: uma tabela por grupo de contextos.
+ */
+long long compactar_contexto_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade, size_t *tam_cabecalho){
+    LEITOR leitor;
+    ESCRITOR escritor;
+    iniciar_leitor_memoria(&leitor, origem, tam_origem);
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+
+    long cabecalho = codificar_contexto_leitor(&leitor, &escritor, tam_origem, NULL);
+    if(cabecalho < 0) return -1;
+    *tam_cabecalho = cabecalho;
+    return escritor.tamanho;
+}
+
+long long descompactar_contexto_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade){
+    if(tam_origem < 3) return -1;
+
+    LEITOR leitor;
+    ESCRITOR escritor;
+    iniciar_leitor_memoria(&leitor, origem + 3, tam_origem - 3);
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+
+    return decodificar_contexto_leitor(&leitor, &escritor, tam_origem) ? (long long)escritor.tamanho : -1;
+}
+
+/**
+ * @brief Soma os cabeçalhos de um arquivo em blocos: o do arquivo, o índice e o cabeçalho de cada bloco.
+ *
+ * @param dados Arquivo em blocos.
+ * @return size_t Total de bytes de cabeçalho.
+ */
+size_t cabecalhos_blocos(const unsigned char *dados){
+    size_t posicao = 8, total = 12;
+
+    while(extrair_u32(dados + posicao) != 0){
+        unsigned long tam_bloco = extrair_u32(dados + posicao + 4);
+        const unsigned char *bloco = dados + posicao + 8;
+        unsigned char tamanhos[TAM_ASCII];
+        int lixo;
+
+        LEITOR leitor;
+        iniciar_leitor_memoria(&leitor, bloco + 3, tam_bloco - 3);
+        if(bloco[2] == FORMATO_QUATRO_FLUXOS)
+            total += 8 + 3 + ler_tabela_tamanhos(&leitor, tamanhos) + 4 * (N_FLUXOS - 1);
+        else
+            total += 8 + ler_cabecalho_canonico(&leitor, tamanhos, &lixo);
+        posicao += 8 + tam_bloco;
+    }
+    return total;
+}
+
+/**
+ * @brief Modo em blocos (API em memória, uma thread), com um fluxo por bloco.
+ */
+long long compactar_blocos_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade, size_t *tam_cabecalho){
+    long long tamanho = compactar_memoria(origem, tam_origem, destino, capacidade, 0, 0);
+    if(tamanho < 0) return -1;
+
+    *tam_cabecalho = cabecalhos_blocos(destino);
+    return tamanho;
+}
+
+/**
+ * @brief Modo em blocos com quatro fluxos intercalados por bloco.
+ */
+long long compactar_fluxos_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade, size_t *tam_cabecalho){
+    long long tamanho = compactar_memoria(origem, tam_origem, destino, capacidade, 0, 1);
+    if(tamanho < 0) return -1;
+
+    *tam_cabecalho = cabecalhos_blocos(destino);
+    return tamanho;
+}
+
+long long descompactar_blocos_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade){
+    return descompactar_memoria(origem, tam_origem, destino, capacidade);
+}
+
+/**
+ * @brief Modo de 16 bits: cada par de bytes é um símbolo, com a tabela larga no cabeçalho.
+ */
+long long compactar_largo_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade, size_t *tam_cabecalho){
+    LEITOR leitor;
+    ESCRITOR escritor;
+    iniciar_leitor_memoria(&leitor, origem, tam_origem);
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+
+    long cabecalho = codificar_largo_leitor(&leitor, &escritor, tam_origem, 0, NULL);
+    if(cabecalho < 0) return -1;
+    *tam_cabecalho = cabecalho;
+    return escritor.tamanho;
+}
+
+long long descompactar_largo_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade){
+    if(tam_origem < 3) return -1;
+
+    LEITOR leitor;
+    ESCRITOR escritor;
+    iniciar_leitor_memoria(&leitor, origem + 3, tam_origem - 3);
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+
+    return decodificar_largo_leitor(&leitor, &escritor, tam_origem) ? (long long)escritor.tamanho : -1;
+}
+
+/**
+ * @brief Modo adaptativo: sem tabela, só a assinatura e a versão no cabeçalho.
+ */
+long long compactar_adaptativo_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade, size_t *tam_cabecalho){
+    LEITOR leitor;
+    ESCRITOR escritor;
+    iniciar_leitor_memoria(&leitor, origem, tam_origem);
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+
+    if(codificar_adaptativo_leitor(&leitor, &escritor) < 0) return -1;
+    *tam_cabecalho = 3;
+    return escritor.tamanho;
+}
+
+long long descompactar_adaptativo_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade){
+    if(tam_origem < 3) return -1;
+
+    LEITOR leitor;
+    ESCRITOR escritor;
+    iniciar_leitor_memoria(&leitor, origem + 3, tam_origem - 3);
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+
+    return decodificar_adaptativo_leitor(&leitor, &escritor) ? (long long)escritor.tamanho : -1;
+}
+
+/**
+ * @brief Gera o corpus, mede um modo e preenche o resultado.
+ *
+ * @param resultado Ponteiro para o resultado, com corpus, modo e tam_original já preenchidos.
+ * @param modo Modo medido.
+ * @param repeticoes Quantidade de repetições de cada medida.
+ */
+void medir(RESULTADO *resultado, const MODO *modo, int repeticoes){
+    size_t tamanho = resultado->tam_original;
+    size_t capacidade = 2 * tamanho + (1 << 16);
+    unsigned char *original = malloc(tamanho > 0 ? tamanho : 1);
+    unsigned char *compactado = malloc(capacidade);
+    unsigned char *restaurado = malloc(tamanho > 0 ? tamanho : 1);
+
+    resultado->ok = 0;
+    if(!original || !compactado || !restaurado){
+        free(original);
+        free(compactado);
+        free(restaurado);
+        return;
+    }
+    gerar_corpus(resultado->corpus, original, tamanho);
+
+    double melhor_compactar = 0, melhor_descompactar = 0;
+    long long tam_compactado = -1, tam_restaurado = -1;
+
+    for(int r = 0; r < repeticoes; r++){
+        double inicio = agora();
+        tam_compactado = modo->compactar(original, tamanho, compactado, capacidade, &resultado->tam_cabecalho);
+        double meio = agora();
+        if(tam_compactado < 0) break;
+        tam_restaurado = modo->descompactar(compactado, tam_compactado, restaurado, tamanho);
+        double fim = agora();
+
+        if(r == 0 || meio - inicio < melhor_compactar) melhor_compactar = meio - inicio;
+        if(r == 0 || fim - meio < melhor_descompactar) melhor_descompactar = fim - meio;
+    }
+
+    resultado->ok = tam_compactado >= 0 && tam_restaurado == (long long)tamanho && memcmp(original, restaurado, tamanho) == 0;
+    resultado->tam_compactado = tam_compactado > 0 ? tam_compactado : 0;
+    resultado->mb_compactar = melhor_compactar > 0 ? tamanho / 1e6 / melhor_compactar : 0;
+    resultado->mb_descompactar = melhor_descompactar > 0 ? tamanho / 1e6 / melhor_descompactar : 0;
+
+    free(original);
+    free(compactado);
+    free(restaurado);
+}
+
+/**
+ * @brief Mede um caso em um processo separado, para que o pico de memória seja só dele.
+ *
+ * @param resultado Ponteiro para o resultado, com corpus, modo e tam_original já preenchidos.
+ * @param modo Modo medido.
+ * @param repeticoes Quantidade de repetições de cada medida.
+ */
+void medir_isolado(RESULTADO *resultado, const MODO *modo, int repeticoes){
+    resultado->memoria_kb = -1;
+#ifdef _WIN32
+    medir(resultado, modo, repeticoes);
+#else
+    int canal[2];
+    if(pipe(canal) != 0){
+        medir(resultado, modo, repeticoes);
+        return;
+    }
+
+    fflush(NULL);
+    pid_t filho = fork();
+    if(filho < 0){
+        close(canal[0]);
+        close(canal[1]);
+        medir(resultado, modo, repeticoes);
+        return;
+    }
+
+    if(filho == 0){
+        close(canal[0]);
+        medir(resultado, modo, repeticoes);
+
+        // O pico é lido pelo próprio filho: com RUSAGE_CHILDREN, o pai veria o maior de todos os filhos já medidos
+        struct rusage uso;
+        if(getrusage(RUSAGE_SELF, &uso) == 0){
+#ifdef __APPLE__
+            resultado->memoria_kb = uso.ru_maxrss / 1024;
+#else
+            resultado->memoria_kb = uso.ru_maxrss;
+#endif
+        }
+        ssize_t escritos = write(canal[1], resultado, sizeof(RESULTADO));
+        _exit(escritos == (ssize_t)sizeof(RESULTADO) ? 0 : 1);
+    }
+
+    close(canal[1]);
+    RESULTADO recebido;
+    ssize_t lidos = read(canal[0], &recebido, sizeof(RESULTADO));
+    close(canal[0]);
+
+    int estado;
+    if(waitpid(filho, &estado, 0) < 0 || lidos != (ssize_t)sizeof(RESULTADO)){
+        resultado->ok = 0;
+        return;
+    }
+
+    *resultado = recebido;
+#endif
+}
+
+/**
+ * @brief Escreve um resultado em CSV ou JSON.
+ *
+ * @param saida Arquivo de saída.
+ * @param resultado Ponteiro para o resultado.
+ * @param rotulo Rótulo da execução (por exemplo, a versão medida).
+ * @param json Indica saída em JSON.
+ * @param primeiro Indica o primeiro resultado (sem vírgula antes, no JSON).
+ */
+void escrever_resultado(FILE *saida, const RESULTADO *resultado, const char *rotulo, int json, int primeiro){
+    double razao = resultado->tam_original ? (double)resultado->tam_compactado / resultado->tam_original : 0;
+    double cabecalho = resultado->tam_compactado ? 100.0 * resultado->tam_cabecalho / resultado->tam_compactado : 0;
+
+    if(json){
+        fprintf(saida, "%s\n  {\"rotulo\": \"%s\", \"corpus\": \"%s\", \"modo\": \"%s\", \"tamanho_original\": %zu, "
+                       "\"tamanho_compactado\": %zu, \"razao\": %.6f, \"cabecalho_bytes\": %zu, \"cabecalho_pct\": %.4f, "
+                       "\"compactar_mb_s\": %.2f, \"descompactar_mb_s\": %.2f, \"memoria_pico_kb\": %ld, \"ok\": %s}",
+                primeiro ? "" : ",", rotulo, resultado->corpus, resultado->modo, resultado->tam_original,
+                resultado->tam_compactado, razao, resultado->tam_cabecalho, cabecalho,
+                resultado->mb_compactar, resultado->mb_descompactar, resultado->memoria_kb, resultado->ok ? "true" : "false");
+    }else{
+        fprintf(saida, "%s,%s,%s,%zu,%zu,%.6f,%zu,%.4f,%.2f,%.2f,%ld,%d\n",
+                rotulo, resultado->corpus, resultado->modo, resultado->tam_original,
+                resultado->tam_compactado, razao, resultado->tam_cabecalho, cabecalho,
+                resultado->mb_compactar, resultado->mb_descompactar, resultado->memoria_kb, resultado->ok);
+    }
+}
+
+/**
+ * @brief Mostra o uso do benchmark na saída de erro.
+ *
+ * @param programa Nome do programa.
+ */
+void mostrar_uso(const char *programa){
+    fprintf(stderr, "uso: %s [-n MiB] [-r repeticoes] [-j] [-v rotulo] [-o saida]\n", programa);
+    fprintf(stderr, "  -n  tamanho de cada corpus, em MiB (padrao %d)\n", TAM_CORPUS_PADRAO);
+    fprintf(stderr, "  -r  repeticoes de cada medida; vale a mais rapida (padrao %d)\n", REPETICOES_PADRAO);
+    fprintf(stderr, "  -j  escreve JSON em vez de CSV\n");
+    fprintf(stderr, "  -v  rotulo gravado em cada linha (por exemplo, a versao medida)\n");
+    fprintf(stderr, "  -o  arquivo de saida (padrao: saida padrao)\n");
+}
+
+/**
+ * @brief Função principal: mede todos os modos sobre todos os corpora.
+ *
+ * @param argc Quantidade de argumentos.
+ * @param argv Argumentos do programa.
+ * @return int 0 se todos os casos conferiram, 1 se algum falhou ou 2 se os argumentos forem inválidos.
+ */
+int main(int argc, char *argv[]){
+    static const char *corpora[] = {"aleatorio", "enviesado", "texto", "inteiros16", "um_byte"};
+    static const MODO modos[] = {
+        {"canonico", compactar_canonico_memoria, descompactar_canonico_memoria},
+        {"contexto", compactar_contexto_memoria, descompactar_contexto_memoria},
+        {"blocos", compactar_blocos_memoria, descompactar_blocos_memoria},
+        {"quatro_fluxos", compactar_fluxos_memoria, descompactar_blocos_memoria},
+        {"largo", compactar_largo_memoria, descompactar_largo_memoria},
+        {"adaptativo", compactar_adaptativo_memoria, descompactar_adaptativo_memoria},
+    };
+    int n_corpora = sizeof(corpora) / sizeof(corpora[0]);
+    int n_modos = sizeof(modos) / sizeof(modos[0]);
+
+    long mib = TAM_CORPUS_PADRAO;
+    int repeticoes = REPETICOES_PADRAO, json = 0;
+    const char *rotulo = "", *caminho = NULL;
+
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            mib = atol(argv[++i]);
+        else if(strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            repeticoes = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-j") == 0)
+            json = 1;
+        else if(strcmp(argv[i], "-v") == 0 && i + 1 < argc)
+            rotulo = argv[++i];
+        else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            caminho = argv[++i];
+        else{
+            mostrar_uso(argv[0]);
+            return 2;
+        }
+    }
+
+    if(mib <= 0 || mib > 1024 || repeticoes <= 0){
+        mostrar_uso(argv[0]);
+        return 2;
+    }
+
+    FILE *saida = caminho ? fopen(caminho, "w") : stdout;
+    if(!saida){
+        fprintf(stderr, "ERRO AO CRIAR ARQUIVO SAIDA: %s\n", caminho);
+        return 1;
+    }
+
+    if(json)
+        fprintf(saida, "[");
+    else
+        fprintf(saida, "rotulo,corpus,modo,tamanho_original,tamanho_compactado,razao,cabecalho_bytes,cabecalho_pct,"
+                       "compactar_mb_s,descompactar_mb_s,memoria_pico_kb,ok\n");
+
+    int falhas = 0;
+    for(int c = 0; c < n_corpora; c++){
+        for(int m = 0; m < n_modos; m++){
+            RESULTADO resultado = {0};
+            resultado.corpus = corpora[c];
+            resultado.modo = modos[m].nome;
+            resultado.tam_original = (size_t)mib << 20;
+
+            medir_isolado(&resultado, &modos[m], repeticoes);
+            if(!resultado.ok){
+                fprintf(stderr, "ERRO: %s/%s NAO CONFERIU.\n", corpora[c], modos[m].nome);
+                falhas++;
+            }
+
+            escrever_resultado(saida, &resultado, rotulo, json, c == 0 && m == 0);
+            fflush(saida);
+        }
+    }
+
+    if(json)
+        fprintf(saida, "\n]\n");
+    if(saida != stdout)
+        fclose(saida);
+
+    return falhas > 0;
+}
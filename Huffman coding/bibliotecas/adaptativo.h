@@ -0,0 +1,508 @@
+/**
+ * @file adaptativo.h
+ * @brief Modo de Huffman adaptativo (algoritmo FGK), que não precisa contar as frequências antes.
+ *
+ * Compactador e descompactador mantêm a mesma árvore, que começa apenas com o nó NYT ("ainda não
+ * transmitido") e é atualizada a cada caractere. Um caractere já visto é enviado com o código da sua
+ * folha; um caractere novo é enviado com o código do NYT seguido de BITS_SIMBOLO_NOVO bits com o
+ * seu valor. O fim dos dados é o símbolo SIMBOLO_FIM, enviado como um caractere novo.
+ *
+ * Os nós ficam em um vetor numerado de forma que os pesos nunca diminuem com o índice e irmãos
+ * são vizinhos (propriedade dos irmãos); a raiz é o último nó. Como não há cabeçalho nem
+ * tamanhos, a saída de cada trecho lido pode ser entregue na hora.
+ *
+ * Formato do arquivo (versão FORMATO_ADAPTATIVO):
+ * - 2 bytes: assinatura "HF";
+ * - 1 byte: versão do formato;
+ * - os códigos de todos os caracteres e do SIMBOLO_FIM, com o último byte completado com zeros.
+ */
+
+#ifndef ADAPTATIVO_H
+#define ADAPTATIVO_H
+
+#include "buffer_io.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+/**
+ * @def SIMBOLO_FIM
+ * @brief Símbolo que marca o fim dos dados.
+ */
+#define SIMBOLO_FIM TAM_ASCII
+
+/**
+ * @def N_SIMBOLOS_ADAPTATIVO
+ * @brief Quantidade de símbolos do alfabeto adaptativo (256 caracteres e o SIMBOLO_FIM).
+ */
+#define N_SIMBOLOS_ADAPTATIVO (TAM_ASCII + 1)
+
+/**
+ * @def BITS_SIMBOLO_NOVO
+ * @brief Bits usados para enviar o valor de um símbolo que ainda não está na árvore.
+ */
+#define BITS_SIMBOLO_NOVO 9
+
+/**
+ * @def MAX_NOS_ADAPTATIVO
+ * @brief Quantidade máxima de nós: uma folha por símbolo, o NYT e os nós internos.
+ */
+#define MAX_NOS_ADAPTATIVO (2 * (N_SIMBOLOS_ADAPTATIVO + 1) - 1)
+
+/**
+ * @def RAIZ_ADAPTATIVA
+ * @brief Índice da raiz, o nó de maior número.
+ */
+#define RAIZ_ADAPTATIVA (MAX_NOS_ADAPTATIVO - 1)
+
+/**
+ * @def TAM_TRECHO_ADAPTATIVO
+ * @brief Quantidade máxima de bytes lidos de uma vez; a saída de cada trecho é entregue logo em seguida.
+ */
+#define TAM_TRECHO_ADAPTATIVO (1 << 16)
+
+/**
+ * @struct ARVORE_ADAPTATIVA
+ * @brief Árvore do Huffman adaptativo guardada em vetores indexados pelo número do nó.
+ *
+ * - peso: quantidade de vezes que os símbolos abaixo do nó apareceram.
+ * - pai: índice do pai (-1 na raiz).
+ * - filhos: índices dos filhos esquerdo (bit 0) e direito (bit 1), ou -1 nas folhas.
+ * - simbolo: símbolo da folha ou -1 (nós internos e NYT).
+ * - folha: índice da folha de cada símbolo ou -1 se ele ainda não apareceu.
+ * - nyt: índice do nó NYT.
+ */
+typedef struct{
+    unsigned long long peso[MAX_NOS_ADAPTATIVO];
+    short pai[MAX_NOS_ADAPTATIVO];
+    short filhos[MAX_NOS_ADAPTATIVO][2];
+    short simbolo[MAX_NOS_ADAPTATIVO];
+    short folha[N_SIMBOLOS_ADAPTATIVO];
+    short nyt;
+}ARVORE_ADAPTATIVA;
+
+/**
+ * @struct DECODIFICADOR_ADAPTATIVO
+ * @brief Estado do descompactador adaptativo entre um trecho de dados e o seguinte.
+ *
+ * - arvore: árvore atual.
+ * - no: nó alcançado na descida da árvore.
+ * - bits_novo: bits que ainda faltam do valor de um símbolo novo (0 durante a descida).
+ * - simbolo_novo: bits já lidos do valor do símbolo novo.
+ * - fim: indica que o SIMBOLO_FIM foi lido.
+ * - erro: indica que os dados são inválidos.
+ */
+typedef struct{
+    ARVORE_ADAPTATIVA arvore;
+    int no;
+    int bits_novo;
+    int simbolo_novo;
+    int fim;
+    int erro;
+}DECODIFICADOR_ADAPTATIVO;
+
+/**
+ * @brief Inicializa a árvore com apenas o nó NYT, que é a raiz.
+ *
+ * @param arvore Ponteiro para a árvore.
+ */
+void iniciar_arvore_adaptativa(ARVORE_ADAPTATIVA *arvore){
+    for(int i = 0; i < N_SIMBOLOS_ADAPTATIVO; i++)
+        arvore->folha[i] = -1;
+
+    arvore->nyt = RAIZ_ADAPTATIVA;
+    arvore->peso[RAIZ_ADAPTATIVA] = 0;
+    arvore->pai[RAIZ_ADAPTATIVA] = -1;
+    arvore->filhos[RAIZ_ADAPTATIVA][0] = arvore->filhos[RAIZ_ADAPTATIVA][1] = -1;
+    arvore->simbolo[RAIZ_ADAPTATIVA] = -1;
+}
+
+/**
+ * @brief Acerta os ponteiros que apontam para o conteúdo guardado em um índice (pai dos filhos ou folha do símbolo).
+ *
+ * @param arvore Ponteiro para a árvore.
+ * @param no Índice do nó.
+ */
+static inline void religar_no(ARVORE_ADAPTATIVA *arvore, int no){
+    if(arvore->filhos[no][0] >= 0){
+        arvore->pai[arvore->filhos[no][0]] = no;
+        arvore->pai[arvore->filhos[no][1]] = no;
+    }else if(arvore->simbolo[no] >= 0){
+        arvore->folha[arvore->simbolo[no]] = no;
+    }else{
+        arvore->nyt = no;
+    }
+}
+
+/**
+ * @brief Troca de lugar as subárvores de dois nós. O pai de cada posição não muda.
+ *
+ * @param arvore Ponteiro para a árvore.
+ * @param a Índice do primeiro nó.
+ * @param b Índice do segundo nó.
+ */
+void trocar_nos_adaptativos(ARVORE_ADAPTATIVA *arvore, int a, int b){
+    unsigned long long peso = arvore->peso[a];
+    arvore->peso[a] = arvore->peso[b];
+    arvore->peso[b] = peso;
+
+    for(int k = 0; k < 2; k++){
+        short filho = arvore->filhos[a][k];
+        arvore->filhos[a][k] = arvore->filhos[b][k];
+        arvore->filhos[b][k] = filho;
+    }
+
+    short simbolo = arvore->simbolo[a];
+    arvore->simbolo[a] = arvore->simbolo[b];
+    arvore->simbolo[b] = simbolo;
+
+    religar_no(arvore, a);
+    religar_no(arvore, b);
+}
+
+/**
+ * @brief Retorna o nó de maior número com o mesmo peso do nó dado (o líder do bloco).
+ *
+ * Os pesos dos nós acima do nó dado não diminuem com o índice, então basta uma busca binária.
+ *
+ * @param arvore Ponteiro para a árvore.
+ * @param no Índice do nó.
+ * @return int Índice do líder.
+ */
+static inline int lider_do_bloco(const ARVORE_ADAPTATIVA *arvore, int no){
+    int inicio = no, fim = RAIZ_ADAPTATIVA;
+
+    while(inicio < fim){
+        int meio = (inicio + fim + 1) / 2;
+        if(arvore->peso[meio] <= arvore->peso[no])
+            inicio = meio;
+        else
+            fim = meio - 1;
+    }
+    return inicio;
+}
+
+/**
+ * @brief Conta mais uma ocorrência do símbolo e reorganiza a árvore (atualização FGK).
+ *
+ * Um símbolo novo divide o NYT em um novo NYT e na folha do símbolo. Depois, do nó do símbolo até a
+ * raiz, cada nó troca de lugar com o líder do seu bloco (se ele não for o pai) antes de ter o peso
+ * incrementado, o que mantém a propriedade dos irmãos.
+ *
+ * @param arvore Ponteiro para a árvore.
+ * @param simbolo Símbolo que apareceu.
+ */
+void atualizar_arvore_adaptativa(ARVORE_ADAPTATIVA *arvore, int simbolo){
+    int no = arvore->folha[simbolo];
+
+    if(no < 0){
+        int antigo = arvore->nyt;
+        int folha = antigo - 1, novo_nyt = antigo - 2;
+
+        arvore->filhos[antigo][0] = novo_nyt;
+        arvore->filhos[antigo][1] = folha;
+
+        arvore->peso[folha] = 0;
+        arvore->pai[folha] = antigo;
+        arvore->filhos[folha][0] = arvore->filhos[folha][1] = -1;
+        arvore->simbolo[folha] = simbolo;
+
+        arvore->peso[novo_nyt] = 0;
+        arvore->pai[novo_nyt] = antigo;
+        arvore->filhos[novo_nyt][0] = arvore->filhos[novo_nyt][1] = -1;
+        arvore->simbolo[novo_nyt] = -1;
+
+        arvore->folha[simbolo] = folha;
+        arvore->nyt = novo_nyt;
+        no = folha;
+    }
+
+    while(no != RAIZ_ADAPTATIVA){
+        int lider = lider_do_bloco(arvore, no);
+        if(lider != no && lider != arvore->pai[no]){
+            trocar_nos_adaptativos(arvore, no, lider);
+            no = lider;
+        }
+        arvore->peso[no]++;
+        no = arvore->pai[no];
+    }
+    arvore->peso[RAIZ_ADAPTATIVA]++;
+}
+
+/**
+ * @brief Escreve o código de um símbolo e atualiza a árvore.
+ *
+ * @param arvore Ponteiro para a árvore.
+ * @param escritor_bits Escritor de bits de saída.
+ * @param simbolo Caractere (0 a 255) ou SIMBOLO_FIM.
+ */
+void codificar_simbolo_adaptativo(ARVORE_ADAPTATIVA *arvore, ESCRITOR_BITS *escritor_bits, int simbolo){
+    unsigned char caminho[MAX_NOS_ADAPTATIVO];
+    int tamanho = 0;
+    int novo = arvore->folha[simbolo] < 0;
+
+    // O código é o caminho da raiz até a folha; subindo da folha, os bits saem ao contrário
+    for(int no = novo ? arvore->nyt : arvore->folha[simbolo]; no != RAIZ_ADAPTATIVA; no = arvore->pai[no])
+        caminho[tamanho++] = arvore->filhos[arvore->pai[no]][1] == no;
+
+    while(tamanho > 0){
+        int parte = tamanho < 32 ? tamanho : 32;
+        unsigned long long bits = 0;
+        for(int i = 0; i < parte; i++)
+            bits = (bits << 1) | caminho[--tamanho];
+        escrever_bits(escritor_bits, bits, parte);
+    }
+
+    if(novo)
+        escrever_bits(escritor_bits, simbolo, BITS_SIMBOLO_NOVO);
+
+    atualizar_arvore_adaptativa(arvore, simbolo);
+}
+
+/**
+ * @brief Inicializa o estado do descompactador adaptativo.
+ *
+ * @param decodificador Ponteiro para o estado.
+ */
+void iniciar_decodificador_adaptativo(DECODIFICADOR_ADAPTATIVO *decodificador){
+    iniciar_arvore_adaptativa(&decodificador->arvore);
+    decodificador->no = RAIZ_ADAPTATIVA;
+    // Com a árvore vazia o código do NYT não tem bits: o primeiro símbolo começa direto pelo valor
+    decodificador->bits_novo = BITS_SIMBOLO_NOVO;
+    decodificador->simbolo_novo = 0;
+    decodificador->fim = 0;
+    decodificador->erro = 0;
+}
+
+/**
+ * @brief Trata um símbolo decodificado: grava o caractere, atualiza a árvore e volta para a raiz.
+ *
+ * @param decodificador Ponteiro para o estado.
+ * @param simbolo Símbolo decodificado.
+ * @param escritor Escritor de saída.
+ */
+static inline void emitir_simbolo_adaptativo(DECODIFICADOR_ADAPTATIVO *decodificador, int simbolo, ESCRITOR *escritor){
+    if(simbolo == SIMBOLO_FIM){
+        decodificador->fim = 1;
+        return;
+    }
+
+    escrever_byte(escritor, simbolo);
+    atualizar_arvore_adaptativa(&decodificador->arvore, simbolo);
+    decodificador->no = RAIZ_ADAPTATIVA;
+}
+
+/**
+ * @brief Decodifica um trecho de dados adaptativos, continuando de onde o trecho anterior parou.
+ *
+ * @param decodificador Ponteiro para o estado.
+ * @param dados Bytes compactados do trecho.
+ * @param tamanho Quantidade de bytes do trecho.
+ * @param escritor Escritor de saída.
+ * @return int 1 quando o SIMBOLO_FIM foi lido, 0 se ainda faltam dados ou -1 se os dados forem inválidos.
+ */
+int decodificar_trecho_adaptativo(DECODIFICADOR_ADAPTATIVO *decodificador, const unsigned char *dados, size_t tamanho, ESCRITOR *escritor){
+    ARVORE_ADAPTATIVA *arvore = &decodificador->arvore;
+
+    for(size_t i = 0; i < tamanho && !decodificador->fim && !decodificador->erro; i++){
+        for(int b = 7; b >= 0 && !decodificador->fim && !decodificador->erro; b--){
+            int bit = (dados[i] >> b) & 1;
+
+            if(decodificador->bits_novo > 0){
+                decodificador->simbolo_novo = (decodificador->simbolo_novo << 1) | bit;
+                if(--decodificador->bits_novo == 0){
+                    int simbolo = decodificador->simbolo_novo;
+                    if(simbolo > SIMBOLO_FIM || arvore->folha[simbolo] >= 0)
+                        decodificador->erro = 1;
+                    else
+                        emitir_simbolo_adaptativo(decodificador, simbolo, escritor);
+                }
+                continue;
+            }
+
+            int no = arvore->filhos[decodificador->no][bit];
+            if(arvore->filhos[no][0] >= 0){
+                decodificador->no = no;
+            }else if(no == arvore->nyt){
+                decodificador->bits_novo = BITS_SIMBOLO_NOVO;
+                decodificador->simbolo_novo = 0;
+            }else{
+                emitir_simbolo_adaptativo(decodificador, arvore->simbolo[no], escritor);
+            }
+        }
+    }
+
+    if(decodificador->erro || escritor->erro) return -1;
+    return decodificador->fim;
+}
+
+/**
+ * @brief Lê de um arquivo os bytes que já estiverem disponíveis, sem esperar o bloco inteiro.
+ *
+ * Em um pipe, retorna assim que chegar algum dado; por isso não usa o buffer do stdio, e o arquivo
+ * não deve ter sido lido antes com as funções do stdio.
+ *
+ * @param arquivo Arquivo de origem.
+ * @param destino Região que recebe os bytes.
+ * @param capacidade Quantidade máxima de bytes.
+ * @return long Quantidade de bytes lidos, 0 no fim do arquivo ou -1 em caso de erro.
+ */
+long ler_disponivel(FILE *arquivo, unsigned char *destino, size_t capacidade){
+#ifdef _WIN32
+    return _read(_fileno(arquivo), destino, (unsigned int)capacidade);
+#else
+    long lidos;
+    do{
+        lidos = read(fileno(arquivo), destino, capacidade);
+    }while(lidos < 0 && errno == EINTR);
+    return lidos;
+#endif
+}
+
+/**
+ * @brief Compacta um arquivo ou fluxo com Huffman adaptativo, em uma única passada.
+ *
+ * A saída de cada trecho lido é gravada e descarregada antes da leitura seguinte.
+ *
+ * @param arquivo_entrada Arquivo ou fluxo original, ainda não lido pelo stdio.
+ * @param arquivo_saida Arquivo ou fluxo de saída.
+ * @return long long Quantidade de bytes originais compactados ou -1 em caso de erro.
+ */
+long long codificar_adaptativo(FILE *arquivo_entrada, FILE *arquivo_saida){
+    unsigned char *trecho = malloc(TAM_TRECHO_ADAPTATIVO);
+    ARVORE_ADAPTATIVA *arvore = malloc(sizeof(ARVORE_ADAPTATIVA));
+    ESCRITOR escritor;
+
+    if(!trecho || !arvore || !iniciar_escritor(&escritor, arquivo_saida, TAM_BLOCO_IO)){
+        free(trecho);
+        free(arvore);
+        return -1;
+    }
+
+    ESCRITOR_BITS escritor_bits;
+    iniciar_escritor_bits(&escritor_bits, &escritor);
+    iniciar_arvore_adaptativa(arvore);
+
+    unsigned char cabecalho[3] = {ASSINATURA[0], ASSINATURA[1], FORMATO_ADAPTATIVO};
+    escrever_bytes(&escritor, cabecalho, 3);
+
+    long long total = 0;
+    long lidos;
+
+    while((lidos = ler_disponivel(arquivo_entrada, trecho, TAM_TRECHO_ADAPTATIVO)) > 0){
+        for(long i = 0; i < lidos; i++)
+            codificar_simbolo_adaptativo(arvore, &escritor_bits, trecho[i]);
+        total += lidos;
+
+        esvaziar_bits(&escritor_bits);
+        descarregar_escritor(&escritor);
+        fflush(arquivo_saida);
+    }
+
+    codificar_simbolo_adaptativo(arvore, &escritor_bits, SIMBOLO_FIM);
+    finalizar_bits(&escritor_bits);
+    liberar_escritor(&escritor);
+
+    int ok = lidos == 0 && !escritor.erro && fflush(arquivo_saida) == 0;
+
+    free(trecho);
+    free(arvore);
+    return ok ? total : -1;
+}
+
+/**
+ * @brief Compacta com Huffman adaptativo os dados de um leitor (arquivo ou memória).
+ *
+ * @param leitor Leitor posicionado no início dos dados originais.
+ * @param escritor Escritor de saída.
+ * @return long long Quantidade de bytes originais compactados ou -1 em caso de erro.
+ */
+long long codificar_adaptativo_leitor(LEITOR *leitor, ESCRITOR *escritor){
+    ARVORE_ADAPTATIVA *arvore = malloc(sizeof(ARVORE_ADAPTATIVA));
+    if(!arvore) return -1;
+
+    ESCRITOR_BITS escritor_bits;
+    iniciar_escritor_bits(&escritor_bits, escritor);
+    iniciar_arvore_adaptativa(arvore);
+
+    unsigned char cabecalho[3] = {ASSINATURA[0], ASSINATURA[1], FORMATO_ADAPTATIVO};
+    escrever_bytes(escritor, cabecalho, 3);
+
+    long long total = 0;
+    while(recarregar_leitor(leitor) > 0){
+        for(size_t i = 0; i < leitor->tamanho; i++)
+            codificar_simbolo_adaptativo(arvore, &escritor_bits, leitor->dados[i]);
+        total += leitor->tamanho;
+    }
+
+    codificar_simbolo_adaptativo(arvore, &escritor_bits, SIMBOLO_FIM);
+    finalizar_bits(&escritor_bits);
+
+    free(arvore);
+    return escritor->erro ? -1 : total;
+}
+
+/**
+ * @brief Descompacta um fluxo adaptativo lido direto do arquivo, entregando a saída de cada trecho na hora.
+ *
+ * @param arquivo_entrada Arquivo ou fluxo compactado, posicionado logo depois da assinatura e da versão e ainda não lido pelo stdio.
+ * @param arquivo_saida Arquivo ou fluxo de saída.
+ * @return int 1 em caso de sucesso ou 0 se os dados forem inválidos ou estiverem incompletos.
+ */
+int decodificar_adaptativo(FILE *arquivo_entrada, FILE *arquivo_saida){
+    unsigned char *trecho = malloc(TAM_TRECHO_ADAPTATIVO);
+    DECODIFICADOR_ADAPTATIVO *decodificador = malloc(sizeof(DECODIFICADOR_ADAPTATIVO));
+    ESCRITOR escritor;
+
+    if(!trecho || !decodificador || !iniciar_escritor(&escritor, arquivo_saida, TAM_BLOCO_IO)){
+        free(trecho);
+        free(decodificador);
+        return 0;
+    }
+    iniciar_decodificador_adaptativo(decodificador);
+
+    int estado = 0;
+    long lidos;
+
+    while(estado == 0 && (lidos = ler_disponivel(arquivo_entrada, trecho, TAM_TRECHO_ADAPTATIVO)) > 0){
+        estado = decodificar_trecho_adaptativo(decodificador, trecho, lidos, &escritor);
+        descarregar_escritor(&escritor);
+        fflush(arquivo_saida);
+    }
+    liberar_escritor(&escritor);
+
+    free(trecho);
+    free(decodificador);
+    return estado == 1 && !escritor.erro;
+}
+
+/**
+ * @brief Descompacta dados adaptativos de um leitor (arquivo ou memória).
+ *
+ * @param leitor Leitor posicionado logo depois da assinatura e da versão.
+ * @param escritor Escritor de saída.
+ * @return int 1 em caso de sucesso ou 0 se os dados forem inválidos ou estiverem incompletos.
+ */
+int decodificar_adaptativo_leitor(LEITOR *leitor, ESCRITOR *escritor){
+    DECODIFICADOR_ADAPTATIVO *decodificador = malloc(sizeof(DECODIFICADOR_ADAPTATIVO));
+    if(!decodificador) return 0;
+    iniciar_decodificador_adaptativo(decodificador);
+
+    // Primeiro o que sobrou do bloco atual do leitor, depois os blocos seguintes
+    int estado = decodificar_trecho_adaptativo(decodificador, leitor->dados + leitor->posicao, leitor->tamanho - leitor->posicao, escritor);
+    leitor->posicao = leitor->tamanho;
+
+    while(estado == 0 && recarregar_leitor(leitor) > 0){
+        estado = decodificar_trecho_adaptativo(decodificador, leitor->dados, leitor->tamanho, escritor);
+        leitor->posicao = leitor->tamanho;
+    }
+
+    free(decodificador);
+    return estado == 1 && !escritor->erro;
+}
+
+#endif
@@ -0,0 +1,275 @@
+/**
+ * @file blocos.h
+ * @brief Modo em blocos independentes, compactados e descompactados em paralelo.
+ *
+ * A entrada é dividida em blocos de tamanho fixo; cada bloco conta as próprias frequências e vira um
+ * fluxo canônico completo (com assinatura, versão e cabeçalho próprios) ou, se pedido, quatro
+ * fluxos intercalados (fluxos.h). Lotes de blocos são
+ * processados pelo pool de threads e gravados na ordem original.
+ *
+ * Formato do arquivo (versão FORMATO_BLOCOS):
+ * - 2 bytes: assinatura "HF";
+ * - 1 byte: versão do formato;
+ * - 1 byte: tamanho máximo dos códigos usado na compactação (0 sem limite), com o bit COM_INDICE
+ *   ligado quando o arquivo termina com o rodapé descrito em indice.h;
+ * - 4 bytes: tamanho dos blocos originais;
+ * - para cada bloco, o índice do bloco (4 bytes com o tamanho original e 4 bytes com o tamanho
+ *   compactado) seguido do bloco compactado;
+ * - 4 bytes zerados marcando o fim;
+ * - opcionalmente, o rodapé com o índice dos blocos e as somas de verificação.
+ */
+
+#ifndef BLOCOS_H
+#define BLOCOS_H
+
+#include "indice.h"
+#include "paralelo.h"
+
+/**
+ * @struct TRABALHO_BLOCO
+ * @brief Dados de um bloco entregue a uma thread do pool.
+ *
+ * - original: bytes originais do bloco.
+ * - tam_original: quantidade de bytes originais.
+ * - compactado: bytes compactados do bloco.
+ * - tam_compactado: quantidade de bytes compactados.
+ * - capacidade: espaço disponível na região de saída da tarefa.
+ * - max_bits: tamanho máximo dos códigos (0 sem limite).
+ * - quatro_fluxos: indica que o bloco é gravado em quatro fluxos.
+ * - verificar: indica que a tarefa também calcula a soma de verificação dos bytes originais.
+ * - soma: soma de verificação dos bytes originais.
+ * - ok: resultado da tarefa.
+ */
+typedef struct{
+    unsigned char *original;
+    size_t tam_original;
+    unsigned char *compactado;
+    size_t tam_compactado;
+    size_t capacidade;
+    int max_bits;
+    int quatro_fluxos;
+    int verificar;
+    unsigned long soma;
+    int ok;
+}TRABALHO_BLOCO;
+
+/**
+ * @brief Tarefa do pool que compacta um bloco em memória.
+ *
+ * @param argumento Ponteiro para o TRABALHO_BLOCO.
+ */
+void compactar_bloco(void *argumento){
+    TRABALHO_BLOCO *trabalho = argumento;
+    long tam_compactado = compactar_bloco_memoria(trabalho->original, trabalho->tam_original, trabalho->compactado, trabalho->capacidade, trabalho->max_bits, trabalho->quatro_fluxos);
+
+    trabalho->ok = tam_compactado >= 0;
+    trabalho->tam_compactado = trabalho->ok ? (size_t)tam_compactado : 0;
+    if(trabalho->verificar)
+        trabalho->soma = soma_verificacao(trabalho->original, trabalho->tam_original);
+}
+
+/**
+ * @brief Tarefa do pool que descompacta um bloco em memória.
+ *
+ * @param argumento Ponteiro para o TRABALHO_BLOCO.
+ */
+void descompactar_bloco(void *argumento){
+    TRABALHO_BLOCO *trabalho = argumento;
+    trabalho->ok = descompactar_bloco_memoria(trabalho->compactado, trabalho->tam_compactado, trabalho->original, trabalho->tam_original);
+    if(trabalho->ok && trabalho->verificar)
+        trabalho->soma = soma_verificacao(trabalho->original, trabalho->tam_original);
+}
+
+/**
+ * @brief Libera os vetores dos trabalhos de um lote.
+ *
+ * @param trabalhos Vetor de trabalhos.
+ * @param lote Quantidade de trabalhos.
+ */
+void liberar_trabalhos(TRABALHO_BLOCO *trabalhos, int lote){
+    if(!trabalhos) return;
+
+    for(int i = 0; i < lote; i++){
+        free(trabalhos[i].original);
+        free(trabalhos[i].compactado);
+    }
+    free(trabalhos);
+}
+
+/**
+ * @brief Aloca os vetores dos trabalhos de um lote.
+ *
+ * @param lote Quantidade de trabalhos.
+ * @param tam_bloco Tamanho dos blocos originais.
+ * @return TRABALHO_BLOCO* Vetor de trabalhos ou NULL se faltar memória.
+ */
+TRABALHO_BLOCO *criar_trabalhos(int lote, size_t tam_bloco){
+    TRABALHO_BLOCO *trabalhos = calloc(lote, sizeof(TRABALHO_BLOCO));
+    if(!trabalhos) return NULL;
+
+    for(int i = 0; i < lote; i++){
+        trabalhos[i].capacidade = limite_bloco_canonico(tam_bloco);
+        trabalhos[i].original = malloc(tam_bloco);
+        trabalhos[i].compactado = malloc(trabalhos[i].capacidade);
+        if(!trabalhos[i].original || !trabalhos[i].compactado){
+            liberar_trabalhos(trabalhos, lote);
+            return NULL;
+        }
+    }
+
+    return trabalhos;
+}
+
+/**
+ * @brief Compacta um arquivo em blocos independentes, usando várias threads.
+ *
+ * @param arquivo_entrada Arquivo original, posicionado no início.
+ * @param arquivo_saida Arquivo de saída.
+ * @param tam_bloco Tamanho dos blocos (0 usa TAM_BLOCO_HUFFMAN).
+ * @param max_bits Tamanho máximo dos códigos (0 para não limitar).
+ * @param n_threads Quantidade de threads (0 usa a quantidade de processadores).
+ * @param com_indice Indica que o rodapé com o índice e as somas de verificação deve ser gravado.
+ * @param quatro_fluxos Indica que cada bloco deve ser gravado em quatro fluxos.
+ * @return long Quantidade de blocos gravados ou -1 em caso de erro.
+ */
+long compactar_blocos(FILE *arquivo_entrada, FILE *arquivo_saida, size_t tam_bloco, int max_bits, int n_threads, int com_indice, int quatro_fluxos){
+    if(tam_bloco == 0) tam_bloco = TAM_BLOCO_HUFFMAN;
+    if(tam_bloco > MAX_BLOCO_HUFFMAN) tam_bloco = MAX_BLOCO_HUFFMAN;
+    if(n_threads <= 0) n_threads = numero_processadores();
+
+    POOL pool;
+    int lote = n_threads;
+    TRABALHO_BLOCO *trabalhos = criar_trabalhos(lote, tam_bloco);
+    if(!trabalhos || !iniciar_pool(&pool, n_threads, lote)){
+        liberar_trabalhos(trabalhos, lote);
+        return -1;
+    }
+
+    unsigned char cabecalho[8] = {ASSINATURA[0], ASSINATURA[1], FORMATO_BLOCOS, max_bits | (com_indice ? COM_INDICE : 0)};
+    gravar_u32(cabecalho + 4, tam_bloco);
+    int ok = fwrite(cabecalho, 1, 8, arquivo_saida) == 8;
+    long blocos = 0;
+
+    INDICE indice_blocos;
+    iniciar_indice(&indice_blocos);
+    unsigned long long posicao = 8, tam_total = 0;
+
+    while(ok){
+        int lidos = 0;
+        for(; lidos < lote; lidos++){
+            trabalhos[lidos].tam_original = fread(trabalhos[lidos].original, 1, tam_bloco, arquivo_entrada);
+            if(trabalhos[lidos].tam_original == 0) break;
+            trabalhos[lidos].max_bits = max_bits;
+            trabalhos[lidos].quatro_fluxos = quatro_fluxos;
+            trabalhos[lidos].verificar = com_indice;
+            enviar_tarefa(&pool, compactar_bloco, &trabalhos[lidos]);
+        }
+        esperar_pool(&pool);
+
+        for(int i = 0; i < lidos && ok; i++){
+            unsigned char indice[8];
+            gravar_u32(indice, trabalhos[i].tam_original);
+            gravar_u32(indice + 4, trabalhos[i].tam_compactado);
+
+            ok = trabalhos[i].ok &&
+                 fwrite(indice, 1, 8, arquivo_saida) == 8 &&
+                 fwrite(trabalhos[i].compactado, 1, trabalhos[i].tam_compactado, arquivo_saida) == trabalhos[i].tam_compactado &&
+                 (!com_indice || adicionar_bloco_indice(&indice_blocos, posicao, trabalhos[i].soma));
+            posicao += 8 + trabalhos[i].tam_compactado;
+            tam_total += trabalhos[i].tam_original;
+            blocos++;
+        }
+
+        if(lidos < lote) break;
+    }
+
+    unsigned char fim[4] = {0};
+    ok = ok && fwrite(fim, 1, 4, arquivo_saida) == 4;
+    ok = ok && (!com_indice || gravar_indice(&indice_blocos, tam_total, arquivo_saida));
+
+    liberar_indice(&indice_blocos);
+    encerrar_pool(&pool);
+    liberar_trabalhos(trabalhos, lote);
+    return ok ? blocos : -1;
+}
+
+/**
+ * @brief Descompacta um arquivo no formato em blocos, usando várias threads.
+ *
+ * Se o arquivo tiver o rodapé, a soma de verificação de cada bloco é calculada junto com a
+ * descompactação e todas são conferidas com o rodapé no final.
+ *
+ * @param leitor Leitor do arquivo compactado, posicionado logo depois da assinatura e da versão.
+ * @param arquivo_saida Arquivo de saída.
+ * @param n_threads Quantidade de threads (0 usa a quantidade de processadores).
+ * @return long Quantidade de blocos descompactados ou -1 se o arquivo for inválido.
+ */
+long descompactar_blocos(LEITOR *leitor, FILE *arquivo_saida, int n_threads){
+    unsigned char cabecalho[5];
+    if(ler_bytes(leitor, cabecalho, 5) != 5)
+        return -1;
+
+    int com_indice = (cabecalho[0] & COM_INDICE) != 0;
+    size_t tam_bloco = extrair_u32(cabecalho + 1);
+    if(tam_bloco == 0 || tam_bloco > MAX_BLOCO_HUFFMAN)
+        return -1;
+    if(n_threads <= 0) n_threads = numero_processadores();
+
+    POOL pool;
+    int lote = n_threads;
+    TRABALHO_BLOCO *trabalhos = criar_trabalhos(lote, tam_bloco);
+    if(!trabalhos || !iniciar_pool(&pool, n_threads, lote)){
+        liberar_trabalhos(trabalhos, lote);
+        return -1;
+    }
+
+    int ok = 1, fim = 0;
+    long blocos = 0;
+
+    INDICE indice_blocos;
+    iniciar_indice(&indice_blocos);
+    unsigned long long posicao = 8, tam_total = 0;
+
+    while(ok && !fim){
+        int lidos = 0;
+        for(; lidos < lote && ok; lidos++){
+            unsigned char indice[8];
+            if(ler_bytes(leitor, indice, 4) != 4){
+                ok = 0;
+                break;
+            }
+
+            TRABALHO_BLOCO *trabalho = &trabalhos[lidos];
+            trabalho->tam_original = extrair_u32(indice);
+            if(trabalho->tam_original == 0){
+                fim = 1;
+                break;
+            }
+
+            ok = ler_bytes(leitor, indice + 4, 4) == 4;
+            trabalho->tam_compactado = extrair_u32(indice + 4);
+            trabalho->verificar = com_indice;
+            ok = ok && trabalho->tam_original <= tam_bloco && trabalho->tam_compactado <= trabalho->capacidade &&
+                 ler_bytes(leitor, trabalho->compactado, trabalho->tam_compactado) == trabalho->tam_compactado;
+
+            if(ok) enviar_tarefa(&pool, descompactar_bloco, trabalho);
+        }
+        esperar_pool(&pool);
+
+        for(int i = 0; i < lidos && ok; i++){
+            ok = trabalhos[i].ok && fwrite(trabalhos[i].original, 1, trabalhos[i].tam_original, arquivo_saida) == trabalhos[i].tam_original &&
+                 (!com_indice || adicionar_bloco_indice(&indice_blocos, posicao, trabalhos[i].soma));
+            posicao += 8 + trabalhos[i].tam_compactado;
+            tam_total += trabalhos[i].tam_original;
+            blocos++;
+        }
+    }
+    ok = ok && (!com_indice || conferir_indice(&indice_blocos, tam_total, leitor));
+
+    liberar_indice(&indice_blocos);
+    encerrar_pool(&pool);
+    liberar_trabalhos(trabalhos, lote);
+    return ok ? blocos : -1;
+}
+
+#endif
@@ -0,0 +1,450 @@
+/**
+ * @file buffer_io.h
+ * @brief Camada de leitura e escrita bufferizada em blocos, usada pelas etapas de compactação e descompactação.
+ *
+ * Em vez de chamar fread/fwrite uma vez por byte, os dados são movidos em blocos de tamanho
+ * configurável (por padrão TAM_BLOCO_IO), e o acesso byte a byte acontece apenas na memória.
+ */
+
+#ifndef BUFFER_IO_H
+#define BUFFER_IO_H
+
+#include "structs.h"
+
+/**
+ * @brief Inicializa um leitor bufferizado sobre um arquivo já aberto.
+ *
+ * @param leitor Ponteiro para o leitor a ser inicializado.
+ * @param arquivo Arquivo de origem, posicionado no ponto onde a leitura deve começar.
+ * @param tam_bloco Tamanho do bloco em bytes (0 usa TAM_BLOCO_IO).
+ * @return int 1 em caso de sucesso ou 0 se não foi possível alocar o bloco.
+ */
+int iniciar_leitor(LEITOR *leitor, FILE *arquivo, size_t tam_bloco){
+    if(tam_bloco == 0) tam_bloco = TAM_BLOCO_IO;
+
+    leitor->arquivo = arquivo;
+    leitor->dados = malloc(tam_bloco);
+    leitor->capacidade = tam_bloco;
+    leitor->tamanho = 0;
+    leitor->posicao = 0;
+    leitor->esgotado = 0;
+
+    return leitor->dados != NULL;
+}
+
+/**
+ * @brief Inicializa um leitor que percorre uma região de memória, sem cópia.
+ *
+ * @param leitor Ponteiro para o leitor a ser inicializado.
+ * @param dados Início da região.
+ * @param tamanho Tamanho da região em bytes.
+ */
+void iniciar_leitor_memoria(LEITOR *leitor, const unsigned char *dados, size_t tamanho){
+    leitor->arquivo = NULL;
+    leitor->dados = (unsigned char*)dados;
+    leitor->capacidade = tamanho;
+    leitor->tamanho = 0;
+    leitor->posicao = 0;
+    leitor->esgotado = 0;
+}
+
+/**
+ * @brief Descarta o bloco atual e carrega o próximo bloco do arquivo.
+ *
+ * @param leitor Ponteiro para o leitor.
+ * @return size_t Quantidade de bytes carregados (0 no fim do arquivo).
+ */
+size_t recarregar_leitor(LEITOR *leitor){
+    if(!leitor->arquivo){
+        leitor->tamanho = leitor->esgotado ? 0 : leitor->capacidade;
+        leitor->posicao = 0;
+        leitor->esgotado = 1;
+        return leitor->tamanho;
+    }
+
+    leitor->tamanho = fread(leitor->dados, sizeof(unsigned char), leitor->capacidade, leitor->arquivo);
+    leitor->posicao = 0;
+    return leitor->tamanho;
+}
+
+/**
+ * @brief Volta o leitor para o início do arquivo ou da região de memória.
+ *
+ * @param leitor Ponteiro para o leitor.
+ */
+void reiniciar_leitor(LEITOR *leitor){
+    if(leitor->arquivo)
+        rewind(leitor->arquivo);
+    leitor->tamanho = leitor->posicao = 0;
+    leitor->esgotado = 0;
+}
+
+/**
+ * @brief Lê o próximo byte do leitor, recarregando o bloco quando ele se esgota.
+ *
+ * @param leitor Ponteiro para o leitor.
+ * @param byte Ponteiro para guardar o byte lido.
+ * @return int 1 se um byte foi lido ou 0 no fim do arquivo.
+ */
+static inline int ler_byte(LEITOR *leitor, unsigned char *byte){
+    if(leitor->posicao == leitor->tamanho && recarregar_leitor(leitor) == 0)
+        return 0;
+
+    *byte = leitor->dados[leitor->posicao++];
+    return 1;
+}
+
+/**
+ * @brief Lê uma sequência de bytes do leitor.
+ *
+ * @param leitor Ponteiro para o leitor.
+ * @param destino Região que recebe os bytes.
+ * @param quantidade Quantidade de bytes desejada.
+ * @return size_t Quantidade de bytes realmente lidos (menor que a desejada no fim dos dados).
+ */
+size_t ler_bytes(LEITOR *leitor, unsigned char *destino, size_t quantidade){
+    size_t lidos = 0;
+
+    while(lidos < quantidade){
+        if(leitor->posicao == leitor->tamanho && recarregar_leitor(leitor) == 0)
+            break;
+
+        size_t disponivel = leitor->tamanho - leitor->posicao;
+        size_t parte = quantidade - lidos < disponivel ? quantidade - lidos : disponivel;
+
+        memcpy(destino + lidos, leitor->dados + leitor->posicao, parte);
+        leitor->posicao += parte;
+        lidos += parte;
+    }
+
+    return lidos;
+}
+
+/**
+ * @brief Lê um inteiro de 32 bits gravado do byte mais significativo para o menos significativo.
+ *
+ * @param leitor Ponteiro para o leitor.
+ * @param valor Ponteiro para guardar o valor lido.
+ * @return int 1 se os 4 bytes foram lidos ou 0 no fim dos dados.
+ */
+int ler_u32(LEITOR *leitor, unsigned long *valor){
+    unsigned char bytes[4];
+    if(ler_bytes(leitor, bytes, 4) != 4) return 0;
+
+    *valor = ((unsigned long)bytes[0] << 24) | ((unsigned long)bytes[1] << 16) | ((unsigned long)bytes[2] << 8) | bytes[3];
+    return 1;
+}
+
+/**
+ * @brief Libera o bloco do leitor. O arquivo continua aberto e a memória de um leitor de memória não é liberada.
+ *
+ * @param leitor Ponteiro para o leitor.
+ */
+void liberar_leitor(LEITOR *leitor){
+    if(leitor->arquivo)
+        free(leitor->dados);
+    leitor->dados = NULL;
+    leitor->tamanho = leitor->posicao = leitor->capacidade = 0;
+}
+
+/**
+ * @brief Inicializa um escritor bufferizado sobre um arquivo já aberto.
+ *
+ * @param escritor Ponteiro para o escritor a ser inicializado.
+ * @param arquivo Arquivo de destino, posicionado no ponto onde a escrita deve começar.
+ * @param tam_bloco Tamanho do bloco em bytes (0 usa TAM_BLOCO_IO).
+ * @return int 1 em caso de sucesso ou 0 se não foi possível alocar o bloco.
+ */
+int iniciar_escritor(ESCRITOR *escritor, FILE *arquivo, size_t tam_bloco){
+    if(tam_bloco == 0) tam_bloco = TAM_BLOCO_IO;
+
+    escritor->arquivo = arquivo;
+    escritor->dados = malloc(tam_bloco);
+    escritor->capacidade = tam_bloco;
+    escritor->tamanho = 0;
+    escritor->crescer = 0;
+    escritor->erro = 0;
+
+    return escritor->dados != NULL;
+}
+
+/**
+ * @brief Inicializa um escritor que grava diretamente em memória.
+ *
+ * @param escritor Ponteiro para o escritor a ser inicializado.
+ * @param destino Região fornecida pelo chamador ou NULL para o escritor alocar (e realocar) a sua.
+ * @param capacidade Tamanho da região fornecida ou capacidade inicial da região alocada.
+ * @return int 1 em caso de sucesso ou 0 se não foi possível alocar a região.
+ */
+int iniciar_escritor_memoria(ESCRITOR *escritor, unsigned char *destino, size_t capacidade){
+    escritor->arquivo = NULL;
+    escritor->crescer = destino == NULL;
+    escritor->erro = 0;
+    escritor->tamanho = 0;
+
+    if(escritor->crescer){
+        if(capacidade == 0) capacidade = 4096;
+        destino = malloc(capacidade);
+        if(!destino) return 0;
+    }
+
+    escritor->dados = destino;
+    escritor->capacidade = capacidade;
+    return 1;
+}
+
+/**
+ * @brief Grava no arquivo todos os bytes pendentes no bloco do escritor.
+ *
+ * @param escritor Ponteiro para o escritor.
+ * @return int 1 em caso de sucesso ou 0 se a escrita falhou.
+ */
+int descarregar_escritor(ESCRITOR *escritor){
+    if(!escritor->arquivo){
+        if(escritor->tamanho < escritor->capacidade)
+            return 1;
+
+        if(escritor->crescer){
+            unsigned char *novo = realloc(escritor->dados, escritor->capacidade * 2);
+            if(novo){
+                escritor->dados = novo;
+                escritor->capacidade *= 2;
+                return 1;
+            }
+        }
+
+        // Sem espaço: os dados seguintes sobrescrevem o início e o escritor fica marcado com erro
+        escritor->erro = 1;
+        escritor->tamanho = 0;
+        return 0;
+    }
+
+    size_t escritos = fwrite(escritor->dados, sizeof(unsigned char), escritor->tamanho, escritor->arquivo);
+    int ok = escritos == escritor->tamanho;
+    if(!ok) escritor->erro = 1;
+    escritor->tamanho = 0;
+    return ok;
+}
+
+/**
+ * @brief Escreve um byte no escritor, descarregando o bloco quando ele enche.
+ *
+ * @param escritor Ponteiro para o escritor.
+ * @param byte Byte a ser escrito.
+ */
+static inline void escrever_byte(ESCRITOR *escritor, unsigned char byte){
+    if(escritor->tamanho == escritor->capacidade)
+        descarregar_escritor(escritor);
+
+    escritor->dados[escritor->tamanho++] = byte;
+}
+
+/**
+ * @brief Escreve uma sequência de bytes no escritor.
+ *
+ * @param escritor Ponteiro para o escritor.
+ * @param bytes Bytes a serem escritos.
+ * @param quantidade Quantidade de bytes.
+ */
+void escrever_bytes(ESCRITOR *escritor, const unsigned char *bytes, size_t quantidade){
+    while(quantidade > 0){
+        if(escritor->tamanho == escritor->capacidade)
+            descarregar_escritor(escritor);
+
+        size_t livre = escritor->capacidade - escritor->tamanho;
+        size_t parte = quantidade < livre ? quantidade : livre;
+
+        memcpy(escritor->dados + escritor->tamanho, bytes, parte);
+        escritor->tamanho += parte;
+        bytes += parte;
+        quantidade -= parte;
+    }
+}
+
+/**
+ * @brief Escreve um inteiro de 32 bits, do byte mais significativo para o menos significativo.
+ *
+ * @param escritor Ponteiro para o escritor.
+ * @param valor Valor a ser escrito (apenas os 32 bits menos significativos).
+ */
+void escrever_u32(ESCRITOR *escritor, unsigned long valor){
+    escrever_byte(escritor, valor >> 24);
+    escrever_byte(escritor, valor >> 16);
+    escrever_byte(escritor, valor >> 8);
+    escrever_byte(escritor, valor);
+}
+
+/**
+ * @brief Descarrega os bytes pendentes e libera o bloco do escritor. O arquivo continua aberto.
+ *
+ * Em um escritor de memória nada é liberado: os dados ficam em escritor->dados, com
+ * escritor->tamanho bytes, e pertencem ao chamador.
+ *
+ * @param escritor Ponteiro para o escritor.
+ */
+void liberar_escritor(ESCRITOR *escritor){
+    if(!escritor->arquivo)
+        return;
+
+    if(escritor->dados && escritor->tamanho > 0)
+        descarregar_escritor(escritor);
+
+    free(escritor->dados);
+    escritor->dados = NULL;
+    escritor->tamanho = escritor->capacidade = 0;
+}
+
+/**
+ * @brief Inicializa um leitor de bits sobre um leitor bufferizado.
+ *
+ * @param leitor_bits Ponteiro para o leitor de bits.
+ * @param leitor Leitor bufferizado de onde os bytes serão retirados.
+ */
+void iniciar_leitor_bits(LEITOR_BITS *leitor_bits, LEITOR *leitor){
+    leitor_bits->leitor = leitor;
+    leitor_bits->acumulador = 0;
+    leitor_bits->quantidade = 0;
+    leitor_bits->fim = 0;
+}
+
+/**
+ * @brief Completa o acumulador com bytes do leitor até ter pelo menos 57 bits válidos.
+ *
+ * Depois do fim dos dados o acumulador é completado com zeros.
+ *
+ * @param leitor_bits Ponteiro para o leitor de bits.
+ */
+static inline void completar_bits(LEITOR_BITS *leitor_bits){
+    unsigned char byte;
+
+    while(leitor_bits->quantidade <= 56 && !leitor_bits->fim){
+        if(!ler_byte(leitor_bits->leitor, &byte)){
+            leitor_bits->fim = 1;
+            break;
+        }
+        leitor_bits->acumulador |= (unsigned long long)byte << (56 - leitor_bits->quantidade);
+        leitor_bits->quantidade += 8;
+    }
+}
+
+/**
+ * @brief Consulta os próximos bits sem consumi-los.
+ *
+ * @param leitor_bits Ponteiro para o leitor de bits.
+ * @param quantidade Quantidade de bits (1 a 57).
+ * @return unsigned long long Os bits consultados, alinhados à direita.
+ */
+static inline unsigned long long espiar_bits(const LEITOR_BITS *leitor_bits, int quantidade){
+    return leitor_bits->acumulador >> (64 - quantidade);
+}
+
+/**
+ * @brief Consome bits já consultados.
+ *
+ * @param leitor_bits Ponteiro para o leitor de bits.
+ * @param quantidade Quantidade de bits (0 a 57).
+ */
+static inline void consumir_bits(LEITOR_BITS *leitor_bits, int quantidade){
+    leitor_bits->acumulador <<= quantidade;
+    leitor_bits->quantidade -= quantidade;
+}
+
+/**
+ * @brief Inicializa um escritor de bits sobre um escritor bufferizado.
+ *
+ * @param escritor_bits Ponteiro para o escritor de bits.
+ * @param escritor Escritor bufferizado que receberá os bytes.
+ */
+void iniciar_escritor_bits(ESCRITOR_BITS *escritor_bits, ESCRITOR *escritor){
+    escritor_bits->escritor = escritor;
+    escritor_bits->acumulador = 0;
+    escritor_bits->quantidade = 0;
+}
+
+/**
+ * @brief Grava os 64 bits de uma palavra no escritor, do byte mais significativo para o menos significativo.
+ *
+ * @param escritor Ponteiro para o escritor.
+ * @param palavra Palavra a ser gravada.
+ */
+static inline void escrever_palavra(ESCRITOR *escritor, unsigned long long palavra){
+    if(escritor->capacidade - escritor->tamanho < 8){
+        if(escritor->arquivo || escritor->crescer)
+            descarregar_escritor(escritor);
+        if(escritor->capacidade - escritor->tamanho < 8){
+            for(int i = 0; i < 8; i++)
+                escrever_byte(escritor, palavra >> (56 - 8 * i));
+            return;
+        }
+    }
+
+    unsigned char *destino = escritor->dados + escritor->tamanho;
+    for(int i = 0; i < 8; i++)
+        destino[i] = palavra >> (56 - 8 * i);
+    escritor->tamanho += 8;
+}
+
+/**
+ * @brief Escreve os bits menos significativos de um valor, do mais significativo para o menos significativo.
+ *
+ * @param escritor_bits Ponteiro para o escritor de bits.
+ * @param bits Valor com os bits alinhados à direita (bits acima de quantidade devem ser zero).
+ * @param quantidade Quantidade de bits (0 a 64).
+ */
+static inline void escrever_bits(ESCRITOR_BITS *escritor_bits, unsigned long long bits, int quantidade){
+    if(quantidade > 32){
+        escrever_bits(escritor_bits, bits >> 32, quantidade - 32);
+        bits &= 0xFFFFFFFFULL;
+        quantidade = 32;
+    }
+
+    int livre = 64 - escritor_bits->quantidade;
+
+    if(quantidade < livre){
+        escritor_bits->acumulador = (escritor_bits->acumulador << quantidade) | bits;
+        escritor_bits->quantidade += quantidade;
+    }else{
+        int sobra = quantidade - livre;
+        unsigned long long palavra = (escritor_bits->acumulador << (livre - 1) << 1) | (bits >> sobra);
+
+        escrever_palavra(escritor_bits->escritor, palavra);
+        escritor_bits->acumulador = sobra ? bits & ((1ULL << sobra) - 1) : 0;
+        escritor_bits->quantidade = sobra;
+    }
+}
+
+/**
+ * @brief Passa para o escritor os bytes completos do acumulador, mantendo apenas os bits que ainda não formam um byte.
+ *
+ * Usada quando a saída precisa ser entregue antes de o acumulador encher (modos de baixa latência).
+ *
+ * @param escritor_bits Ponteiro para o escritor de bits.
+ */
+void esvaziar_bits(ESCRITOR_BITS *escritor_bits){
+    while(escritor_bits->quantidade >= 8){
+        escritor_bits->quantidade -= 8;
+        escrever_byte(escritor_bits->escritor, escritor_bits->acumulador >> escritor_bits->quantidade);
+    }
+    escritor_bits->acumulador &= (1ULL << escritor_bits->quantidade) - 1;
+}
+
+/**
+ * @brief Grava os bits pendentes, completando o último byte com zeros.
+ *
+ * @param escritor_bits Ponteiro para o escritor de bits.
+ * @return int Quantidade de bits de lixo adicionados ao último byte (0 a 7).
+ */
+int finalizar_bits(ESCRITOR_BITS *escritor_bits){
+    int lixo = (8 - escritor_bits->quantidade % 8) % 8;
+    unsigned long long restante = escritor_bits->acumulador << lixo;
+    int bytes = (escritor_bits->quantidade + lixo) / 8;
+
+    for(int i = bytes - 1; i >= 0; i--)
+        escrever_byte(escritor_bits->escritor, restante >> (8 * i));
+
+    escritor_bits->acumulador = 0;
+    escritor_bits->quantidade = 0;
+    return lixo;
+}
+
+#endif
@@ -0,0 +1,432 @@
+/**
+ * @file canonico.h
+ * @brief Modo de Huffman canônico: o cabeçalho guarda só o tamanho do código de cada símbolo.
+ *
+ * Compactador e descompactador geram os mesmos códigos a partir dos tamanhos (códigos canônicos),
+ * então a árvore não precisa ser serializada nem remontada na descompactação.
+ *
+ * Formato do arquivo (versão FORMATO_CANONICO):
+ * - 2 bytes: assinatura "HF";
+ * - 1 byte: versão do formato;
+ * - 1 byte: tamanho do lixo no último byte dos dados (0 a 7);
+ * - 1 byte: largura, em bits, de cada tamanho de código gravado;
+ * - 2 bytes: quantidade de símbolos presentes (0 a 256);
+ * - lista dos símbolos presentes (se forem até 32) ou mapa de 32 bytes com um bit por símbolo;
+ * - tamanhos dos códigos dos símbolos presentes, empacotados com a largura acima;
+ * - dados codificados.
+ *
+ * A assinatura "HF" nunca é um cabeçalho válido do formato antigo de 3 bits de lixo e 13 bits de
+ * árvore, pois corresponderia a uma árvore de 2118 bytes (o máximo possível é 511).
+ */
+
+#ifndef CANONICO_H
+#define CANONICO_H
+
+#include "tabela_decodificacao.h"
+#include "limitado.h"
+
+/**
+ * @brief Gera os códigos canônicos a partir dos tamanhos.
+ *
+ * Os códigos de mesmo tamanho são consecutivos e seguem a ordem dos símbolos; cada tamanho começa
+ * logo depois do último código do tamanho anterior, deslocado de um bit.
+ *
+ * @param tamanhos Tamanho do código de cada símbolo (0 para ausentes).
+ * @param codigos Vetor de saída com os códigos, indexado pelo símbolo.
+ * @param n_simbolos Quantidade de símbolos do alfabeto.
+ */
+void gerar_codigos_canonicos(const unsigned char *tamanhos, CODIGO *codigos, int n_simbolos){
+    unsigned long long quantidade[MAX_BITS_CODIGO + 1] = {0};
+    unsigned long long proximo[MAX_BITS_CODIGO + 1];
+
+    for(int i = 0; i < n_simbolos; i++)
+        quantidade[tamanhos[i]]++;
+    quantidade[0] = 0;
+
+    unsigned long long codigo = 0;
+    for(int tam = 1; tam <= MAX_BITS_CODIGO; tam++){
+        codigo = (codigo + quantidade[tam - 1]) << 1;
+        proximo[tam] = codigo;
+    }
+
+    for(int i = 0; i < n_simbolos; i++){
+        codigos[i].tamanho = tamanhos[i];
+        codigos[i].bits = tamanhos[i] ? proximo[tamanhos[i]]++ : 0;
+    }
+}
+
+/**
+ * @brief Confere se os tamanhos formam um código de prefixo, isto é, se a soma de Kraft não passa de 1.
+ *
+ * Percorre os tamanhos contando os códigos ainda livres em cada nível; se algum tamanho tiver mais
+ * símbolos que códigos livres, gerar_codigos_canonicos produziria códigos maiores que o tamanho.
+ *
+ * @param tamanhos Tamanho do código de cada símbolo (0 para ausentes, no máximo MAX_BITS_CODIGO).
+ * @param n_simbolos Quantidade de símbolos do alfabeto.
+ * @return int 1 se os tamanhos forem válidos ou 0 caso contrário.
+ */
+int verificar_kraft(const unsigned char *tamanhos, long n_simbolos){
+    unsigned long long quantidade[MAX_BITS_CODIGO + 1] = {0};
+
+    for(long i = 0; i < n_simbolos; i++)
+        quantidade[tamanhos[i]]++;
+
+    unsigned long long livres = 1;
+    for(int tam = 1; tam <= MAX_BITS_CODIGO; tam++){
+        livres *= 2;
+        if(quantidade[tam] > livres) return 0;
+        livres -= quantidade[tam];
+        // Com tantos códigos livres quanto símbolos, nenhum nível seguinte estoura; o limite evita overflow
+        if(livres > (unsigned long long)n_simbolos) livres = n_simbolos;
+    }
+    return 1;
+}
+
+/**
+ * @brief Conta quantos bits os dados codificados vão ocupar.
+ *
+ * @param frequencia Frequência de cada símbolo.
+ * @param tamanhos Tamanho do código de cada símbolo.
+ * @param n_simbolos Quantidade de símbolos do alfabeto.
+ * @return unsigned long long Total de bits dos dados.
+ */
+unsigned long long contar_bits(const unsigned long *frequencia, const unsigned char *tamanhos, int n_simbolos){
+    unsigned long long total = 0;
+    for(int i = 0; i < n_simbolos; i++)
+        total += (unsigned long long)frequencia[i] * tamanhos[i];
+    return total;
+}
+
+/**
+ * @brief Calcula os tamanhos dos códigos de Huffman a partir das frequências.
+ *
+ * @param frequencia Frequência de cada símbolo.
+ * @param n_simbolos Quantidade de símbolos do alfabeto.
+ * @param tamanhos Vetor de tamanhos a ser preenchido.
+ * @return int 1 em caso de sucesso ou 0 se algum código passar de MAX_BITS_CODIGO bits.
+ */
+int tamanhos_huffman(const unsigned long *frequencia, int n_simbolos, unsigned char *tamanhos){
+    return tamanhos_huffman_heap(frequencia, n_simbolos, tamanhos);
+}
+
+/**
+ * @brief Calcula quanto o limite de tamanho piora a compressão em relação à árvore sem limite.
+ *
+ * @param frequencia Frequência de cada caractere.
+ * @param max_bits Tamanho máximo dos códigos.
+ * @param bits_livre Ponteiro para guardar o total de bits dos dados sem limite.
+ * @param bits_limitado Ponteiro para guardar o total de bits dos dados com o limite.
+ * @return double Aumento percentual do tamanho dos dados ou -1 se o limite for impossível.
+ */
+double custo_limite(unsigned long *frequencia, int max_bits, unsigned long long *bits_livre, unsigned long long *bits_limitado){
+    unsigned char livre[TAM_ASCII], limitado[TAM_ASCII];
+
+    if(!tamanhos_huffman(frequencia, TAM_ASCII, livre) && !tamanhos_limitados(frequencia, TAM_ASCII, MAX_BITS_CODIGO, livre))
+        return -1;
+    if(!tamanhos_limitados(frequencia, TAM_ASCII, max_bits, limitado))
+        return -1;
+
+    *bits_livre = contar_bits(frequencia, livre, TAM_ASCII);
+    *bits_limitado = contar_bits(frequencia, limitado, TAM_ASCII);
+
+    if(*bits_livre == 0) return 0;
+    return 100.0 * ((double)*bits_limitado - (double)*bits_livre) / (double)*bits_livre;
+}
+
+/**
+ * @brief Calcula o tamanho, em bytes, da tabela de tamanhos (largura, símbolos presentes e tamanhos).
+ *
+ * @param tamanhos Tamanho do código de cada símbolo.
+ * @param largura Ponteiro para guardar a largura de cada tamanho gravado.
+ * @param presentes Ponteiro para guardar a quantidade de símbolos presentes.
+ * @return unsigned long Tamanho da tabela em bytes.
+ */
+unsigned long tamanho_tabela_tamanhos(const unsigned char *tamanhos, int *largura, int *presentes){
+    int maior = 0;
+    *presentes = 0;
+
+    for(int i = 0; i < TAM_ASCII; i++){
+        if(tamanhos[i]){
+            (*presentes)++;
+            if(tamanhos[i] > maior) maior = tamanhos[i];
+        }
+    }
+
+    *largura = 1;
+    while((1 << *largura) <= maior)
+        (*largura)++;
+
+    unsigned long mapa = *presentes <= 32 ? *presentes : 32;
+    return 3 + mapa + ((unsigned long)*presentes * *largura + 7) / 8;
+}
+
+/**
+ * @brief Calcula o tamanho, em bytes, do cabeçalho canônico.
+ *
+ * @param tamanhos Tamanho do código de cada símbolo.
+ * @param largura Ponteiro para guardar a largura de cada tamanho gravado.
+ * @param presentes Ponteiro para guardar a quantidade de símbolos presentes.
+ * @return unsigned long Tamanho do cabeçalho em bytes.
+ */
+unsigned long tamanho_cabecalho_canonico(const unsigned char *tamanhos, int *largura, int *presentes){
+    return 4 + tamanho_tabela_tamanhos(tamanhos, largura, presentes);
+}
+
+/**
+ * @brief Escreve a tabela de tamanhos: largura, símbolos presentes e o tamanho de cada um.
+ *
+ * @param escritor Escritor de saída.
+ * @param tamanhos Tamanho do código de cada caractere.
+ * @return unsigned long Tamanho da tabela em bytes.
+ */
+unsigned long salvar_tabela_tamanhos(ESCRITOR *escritor, const unsigned char *tamanhos){
+    int largura, presentes;
+    unsigned long tam_tabela = tamanho_tabela_tamanhos(tamanhos, &largura, &presentes);
+
+    escrever_byte(escritor, largura);
+    escrever_byte(escritor, presentes >> 8);
+    escrever_byte(escritor, presentes);
+
+    if(presentes <= 32){
+        for(int i = 0; i < TAM_ASCII; i++)
+            if(tamanhos[i]) escrever_byte(escritor, i);
+    }else{
+        unsigned char mapa[32] = {0};
+        for(int i = 0; i < TAM_ASCII; i++)
+            if(tamanhos[i]) mapa[i >> 3] |= 0x80 >> (i & 7);
+        escrever_bytes(escritor, mapa, 32);
+    }
+
+    ESCRITOR_BITS escritor_bits;
+    iniciar_escritor_bits(&escritor_bits, escritor);
+    for(int i = 0; i < TAM_ASCII; i++)
+        if(tamanhos[i]) escrever_bits(&escritor_bits, tamanhos[i], largura);
+    finalizar_bits(&escritor_bits);
+
+    return tam_tabela;
+}
+
+/**
+ * @brief Escreve o cabeçalho canônico.
+ *
+ * @param escritor Escritor de saída.
+ * @param tamanhos Tamanho do código de cada caractere.
+ * @param lixo Quantidade de bits de lixo no último byte dos dados.
+ * @return unsigned long Tamanho do cabeçalho em bytes.
+ */
+unsigned long salvar_cabecalho_canonico(ESCRITOR *escritor, const unsigned char *tamanhos, int lixo){
+    escrever_bytes(escritor, (const unsigned char*)ASSINATURA, 2);
+    escrever_byte(escritor, FORMATO_CANONICO);
+    escrever_byte(escritor, lixo);
+
+    return 4 + salvar_tabela_tamanhos(escritor, tamanhos);
+}
+
+/**
+ * @brief Lê uma tabela de tamanhos gravada por salvar_tabela_tamanhos.
+ *
+ * @param leitor Leitor posicionado no início da tabela.
+ * @param tamanhos Vetor de 256 tamanhos a ser preenchido.
+ * @return long Tamanho da tabela em bytes ou -1 se ela for inválida (inclusive se violar Kraft).
+ */
+long ler_tabela_tamanhos(LEITOR *leitor, unsigned char *tamanhos){
+    unsigned char campos[3];
+
+    for(int i = 0; i < 3; i++)
+        if(!ler_byte(leitor, &campos[i])) return -1;
+
+    int largura = campos[0];
+    int presentes = (campos[1] << 8) | campos[2];
+
+    if(largura < 1 || largura > 7 || presentes > TAM_ASCII)
+        return -1;
+
+    int simbolos[TAM_ASCII];
+    unsigned char byte;
+
+    if(presentes <= 32){
+        for(int i = 0; i < presentes; i++){
+            if(!ler_byte(leitor, &byte)) return -1;
+            simbolos[i] = byte;
+        }
+    }else{
+        int k = 0;
+        for(int i = 0; i < 32; i++){
+            if(!ler_byte(leitor, &byte)) return -1;
+            for(int b = 0; b < 8; b++)
+                if(byte & (0x80 >> b)) simbolos[k++] = i * 8 + b;
+        }
+        if(k != presentes) return -1;
+    }
+
+    memset(tamanhos, 0, TAM_ASCII);
+
+    LEITOR_BITS leitor_bits;
+    iniciar_leitor_bits(&leitor_bits, leitor);
+    for(int i = 0; i < presentes; i++){
+        if(leitor_bits.quantidade < largura){
+            if(!ler_byte(leitor, &byte)) return -1;
+            leitor_bits.acumulador |= (unsigned long long)byte << (56 - leitor_bits.quantidade);
+            leitor_bits.quantidade += 8;
+        }
+        tamanhos[simbolos[i]] = espiar_bits(&leitor_bits, largura);
+        consumir_bits(&leitor_bits, largura);
+        if(tamanhos[simbolos[i]] == 0 || tamanhos[simbolos[i]] > MAX_BITS_CODIGO) return -1;
+    }
+    if(!verificar_kraft(tamanhos, TAM_ASCII))
+        return -1;
+
+    unsigned long mapa = presentes <= 32 ? presentes : 32;
+    return 3 + mapa + ((unsigned long)presentes * largura + 7) / 8;
+}
+
+/**
+ * @brief Lê o cabeçalho canônico logo depois da assinatura e da versão.
+ *
+ * @param leitor Leitor posicionado no byte de lixo.
+ * @param tamanhos Vetor de 256 tamanhos a ser preenchido.
+ * @param lixo Ponteiro para guardar a quantidade de bits de lixo.
+ * @return long Tamanho total do cabeçalho em bytes ou -1 se ele for inválido.
+ */
+long ler_cabecalho_canonico(LEITOR *leitor, unsigned char *tamanhos, int *lixo){
+    unsigned char byte;
+    if(!ler_byte(leitor, &byte) || byte > 7)
+        return -1;
+    *lixo = byte;
+
+    long tam_tabela = ler_tabela_tamanhos(leitor, tamanhos);
+    return tam_tabela < 0 ? -1 : 4 + tam_tabela;
+}
+
+/**
+ * @brief Escolhe os tamanhos dos códigos: Huffman sem limite ou package-merge com max_bits.
+ *
+ * @param frequencia Frequência de cada caractere.
+ * @param max_bits Tamanho máximo dos códigos (0 para não limitar).
+ * @param tamanhos Vetor de 256 tamanhos a ser preenchido.
+ * @return int 1 em caso de sucesso ou 0 se o limite for impossível.
+ */
+int escolher_tamanhos(const unsigned long *frequencia, int max_bits, unsigned char *tamanhos){
+    if(max_bits > 0)
+        return tamanhos_limitados(frequencia, TAM_ASCII, max_bits, tamanhos);
+
+    return tamanhos_huffman(frequencia, TAM_ASCII, tamanhos) || tamanhos_limitados(frequencia, TAM_ASCII, MAX_BITS_CODIGO, tamanhos);
+}
+
+/**
+ * @brief Codifica no formato canônico os dados de um leitor (arquivo ou memória).
+ *
+ * @param leitor Leitor posicionado no início dos dados originais.
+ * @param escritor Escritor de saída.
+ * @param frequencia Frequência de cada caractere dos dados originais.
+ * @param tam_arq Quantidade de bytes a codificar.
+ * @param max_bits Tamanho máximo dos códigos (0 para não limitar).
+ * @return long Tamanho do cabeçalho em bytes ou -1 em caso de erro.
+ */
+long codificar_canonico_leitor(LEITOR *leitor, ESCRITOR *escritor, const unsigned long *frequencia, unsigned long tam_arq, int max_bits){
+    unsigned char tamanhos[TAM_ASCII];
+    CODIGO codigos[TAM_ASCII];
+
+    if(!escolher_tamanhos(frequencia, max_bits, tamanhos))
+        return -1;
+    gerar_codigos_canonicos(tamanhos, codigos, TAM_ASCII);
+
+    int lixo = (8 - contar_bits(frequencia, tamanhos, TAM_ASCII) % 8) % 8;
+    long tam_cabecalho = salvar_cabecalho_canonico(escritor, tamanhos, lixo);
+
+    ESCRITOR_BITS escritor_bits;
+    iniciar_escritor_bits(&escritor_bits, escritor);
+
+    unsigned long restante = tam_arq;
+    while(restante > 0 && recarregar_leitor(leitor) > 0){
+        size_t n = leitor->tamanho < restante ? leitor->tamanho : restante;
+        for(size_t i = 0; i < n; i++){
+            const CODIGO *codigo = &codigos[leitor->dados[i]];
+            escrever_bits(&escritor_bits, codigo->bits, codigo->tamanho);
+        }
+        restante -= n;
+    }
+    finalizar_bits(&escritor_bits);
+
+    return escritor->erro ? -1 : tam_cabecalho;
+}
+
+/**
+ * @brief Compacta um arquivo no formato canônico.
+ *
+ * @param leitor Leitor do arquivo original, posicionado no início.
+ * @param arquivo_saida Arquivo de saída.
+ * @param frequencia Frequência de cada caractere do arquivo original.
+ * @param tam_arq Tamanho do arquivo original.
+ * @param max_bits Tamanho máximo dos códigos (0 para não limitar).
+ * @param tam_bloco Tamanho dos blocos de escrita (0 usa TAM_BLOCO_IO).
+ * @return long Tamanho do cabeçalho em bytes ou -1 em caso de erro.
+ */
+long codificar_canonico(LEITOR *leitor, FILE *arquivo_saida, unsigned long *frequencia, unsigned long tam_arq, int max_bits, size_t tam_bloco){
+    ESCRITOR escritor;
+    if(!iniciar_escritor(&escritor, arquivo_saida, tam_bloco))
+        return -1;
+
+    long tam_cabecalho = codificar_canonico_leitor(leitor, &escritor, frequencia, tam_arq, max_bits);
+
+    liberar_escritor(&escritor);
+    return escritor.erro ? -1 : tam_cabecalho;
+}
+
+/**
+ * @brief Decodifica dados no formato canônico de um leitor (arquivo ou memória).
+ *
+ * @param leitor Leitor posicionado logo depois da assinatura e da versão.
+ * @param escritor Escritor de saída.
+ * @param tam_comprimido Tamanho total dos dados compactados, contando assinatura e versão.
+ * @return int 1 em caso de sucesso ou 0 se os dados forem inválidos.
+ */
+int decodificar_canonico_leitor(LEITOR *leitor, ESCRITOR *escritor, unsigned long tam_comprimido){
+    unsigned char tamanhos[TAM_ASCII];
+    CODIGO codigos[TAM_ASCII];
+    int lixo;
+
+    long tam_cabecalho = ler_cabecalho_canonico(leitor, tamanhos, &lixo);
+    if(tam_cabecalho < 0 || (unsigned long)tam_cabecalho > tam_comprimido)
+        return 0;
+
+    unsigned long long total_bits = (unsigned long long)(tam_comprimido - tam_cabecalho) * 8;
+    if(total_bits < (unsigned long long)lixo)
+        return 0;
+    total_bits -= lixo;
+
+    gerar_codigos_canonicos(tamanhos, codigos, TAM_ASCII);
+
+    TABELA_DECODIFICACAO tabela;
+    if(!construir_tabela(&tabela, codigos, TAM_ASCII))
+        return total_bits == 0;
+
+    LEITOR_BITS leitor_bits;
+    iniciar_leitor_bits(&leitor_bits, leitor);
+    int ok = decodificar_com_tabela(&tabela, &leitor_bits, total_bits, escritor);
+
+    liberar_tabela(&tabela);
+    return ok && !escritor->erro;
+}
+
+/**
+ * @brief Descompacta um arquivo no formato canônico.
+ *
+ * @param leitor Leitor do arquivo compactado, posicionado logo depois da assinatura e da versão.
+ * @param arquivo_saida Arquivo de saída.
+ * @param tam_arq Tamanho total do arquivo compactado.
+ * @param tam_bloco Tamanho dos blocos de escrita (0 usa TAM_BLOCO_IO).
+ * @return int 1 em caso de sucesso ou 0 se o arquivo for inválido.
+ */
+int decodificar_canonico(LEITOR *leitor, FILE *arquivo_saida, unsigned long tam_arq, size_t tam_bloco){
+    ESCRITOR escritor;
+    if(!iniciar_escritor(&escritor, arquivo_saida, tam_bloco))
+        return 0;
+
+    int ok = decodificar_canonico_leitor(leitor, &escritor, tam_arq);
+
+    liberar_escritor(&escritor);
+    return ok && !escritor.erro;
+}
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file construcao.h
+ * @brief Construção dos tamanhos dos códigos de Huffman sobre vetores contíguos.
+ *
+ * Os nós não são alocados um a um: folhas e nós internos ficam em um único vetor e cada nó guarda
+ * apenas o peso e o índice do pai. Como todo nó interno é criado depois dos seus filhos, a
+ * profundidade de cada nó sai de uma única passada do fim para o começo do vetor.
+ *
+ * - tamanhos_huffman_heap: heap mínima de índices, O(n log n) para frequências em qualquer ordem;
+ * - tamanhos_duas_filas: duas filas, O(n) quando as folhas já estão ordenadas pelo peso.
+ */
+
+#ifndef CONSTRUCAO_H
+#define CONSTRUCAO_H
+
+#include "structs.h"
+
+/**
+ * @struct NO_CONSTRUCAO
+ * @brief Nó da árvore guardado no vetor contíguo de construção.
+ *
+ * - peso: frequência da folha ou soma dos pesos dos filhos.
+ * - pai: índice do pai no vetor (-1 na raiz).
+ */
+typedef struct{
+    unsigned long long peso;
+    int pai;
+}NO_CONSTRUCAO;
+
+/**
+ * @brief Converte as profundidades das folhas do vetor de construção em tamanhos de código.
+ *
+ * @param nos Vetor de nós (as n primeiras posições são as folhas).
+ * @param folhas Símbolo de cada folha.
+ * @param n Quantidade de folhas.
+ * @param tamanhos Vetor de saída com o tamanho de cada símbolo.
+ * @return int 1 em caso de sucesso ou 0 se algum código passar de MAX_BITS_CODIGO bits.
+ */
+int profundidades_para_tamanhos(const NO_CONSTRUCAO *nos, const int *folhas, int n, unsigned char *tamanhos){
+    int total = 2 * n - 1;
+    int *profundidade = malloc(total * sizeof(int));
+    if(!profundidade) return 0;
+
+    profundidade[total - 1] = 0;
+    for(int i = total - 2; i >= 0; i--)
+        profundidade[i] = profundidade[nos[i].pai] + 1;
+
+    int ok = 1;
+    for(int i = 0; i < n; i++){
+        if(profundidade[i] > MAX_BITS_CODIGO) ok = 0;
+        tamanhos[folhas[i]] = profundidade[i];
+    }
+
+    free(profundidade);
+    return ok;
+}
+
+/**
+ * @brief Desce um índice na heap de índices até a posição correta.
+ *
+ * @param heap Vetor de índices de nós.
+ * @param tamanho Quantidade de índices na heap.
+ * @param nos Vetor de nós, usado para comparar os pesos.
+ * @param i Posição a ser ajustada.
+ */
+void descer_heap_indices(int *heap, int tamanho, const NO_CONSTRUCAO *nos, int i){
+    int atual = heap[i];
+
+    while(2 * i + 1 < tamanho){
+        int filho = 2 * i + 1;
+        if(filho + 1 < tamanho && nos[heap[filho + 1]].peso < nos[heap[filho]].peso)
+            filho++;
+        if(nos[atual].peso <= nos[heap[filho]].peso)
+            break;
+        heap[i] = heap[filho];
+        i = filho;
+    }
+    heap[i] = atual;
+}
+
+/**
+ * @brief Calcula os tamanhos dos códigos de Huffman com uma heap mínima de índices.
+ *
+ * @param frequencia Frequência de cada símbolo.
+ * @param n_simbolos Quantidade de símbolos do alfabeto.
+ * @param tamanhos Vetor de saída com o tamanho de cada símbolo.
+ * @return int 1 em caso de sucesso ou 0 se faltar memória ou algum código passar de MAX_BITS_CODIGO bits.
+ */
+int tamanhos_huffman_heap(const unsigned long *frequencia, int n_simbolos, unsigned char *tamanhos){
+    memset(tamanhos, 0, n_simbolos);
+
+    int n = 0;
+    for(int i = 0; i < n_simbolos; i++)
+        if(frequencia[i]) n++;
+
+    if(n == 0) return 1;
+
+    NO_CONSTRUCAO *nos = malloc((2 * n - 1) * sizeof(NO_CONSTRUCAO));
+    int *folhas = malloc(n * sizeof(int));
+    int *heap = malloc(n * sizeof(int));
+    if(!nos || !folhas || !heap){
+        free(nos);
+        free(folhas);
+        free(heap);
+        return 0;
+    }
+
+    for(int i = 0, k = 0; i < n_simbolos; i++){
+        if(frequencia[i]){
+            nos[k].peso = frequencia[i];
+            nos[k].pai = -1;
+            folhas[k] = i;
+            heap[k] = k;
+            k++;
+        }
+    }
+
+    int tamanho = n;
+    for(int i = tamanho / 2 - 1; i >= 0; i--)
+        descer_heap_indices(heap, tamanho, nos, i);
+
+    for(int novo = n; novo < 2 * n - 1; novo++){
+        int primeiro = heap[0];
+        heap[0] = heap[--tamanho];
+        descer_heap_indices(heap, tamanho, nos, 0);
+
+        int segundo = heap[0];
+
+        nos[novo].peso = nos[primeiro].peso + nos[segundo].peso;
+        nos[novo].pai = -1;
+        nos[primeiro].pai = nos[segundo].pai = novo;
+
+        heap[0] = novo;
+        descer_heap_indices(heap, tamanho, nos, 0);
+    }
+
+    int ok = profundidades_para_tamanhos(nos, folhas, n, tamanhos);
+    if(n == 1) tamanhos[folhas[0]] = 1;
+
+    free(nos);
+    free(folhas);
+    free(heap);
+    return ok;
+}
+
+/**
+ * @brief Calcula os tamanhos dos códigos de Huffman com duas filas, em tempo linear.
+ *
+ * A primeira fila são as folhas, já ordenadas pelo peso; a segunda são os nós internos, que
+ * nascem em ordem crescente de peso. Os dois menores nós estão sempre no início das filas.
+ *
+ * @param pesos Pesos das folhas, em ordem crescente.
+ * @param simbolos Símbolo de cada folha.
+ * @param n Quantidade de folhas.
+ * @param tamanhos Vetor de saída com o tamanho de cada símbolo (só as posições das folhas são escritas).
+ * @return int 1 em caso de sucesso ou 0 se faltar memória ou algum código passar de MAX_BITS_CODIGO bits.
+ */
+int tamanhos_duas_filas(const unsigned long long *pesos, const int *simbolos, int n, unsigned char *tamanhos){
+    if(n == 0) return 1;
+
+    NO_CONSTRUCAO *nos = malloc((2 * n - 1) * sizeof(NO_CONSTRUCAO));
+    if(!nos) return 0;
+
+    for(int i = 0; i < n; i++){
+        nos[i].peso = pesos[i];
+        nos[i].pai = -1;
+    }
+
+    int proxima_folha = 0, proximo_interno = n;
+
+    for(int novo = n; novo < 2 * n - 1; novo++){
+        int escolhidos[2];
+
+        for(int k = 0; k < 2; k++){
+            if(proxima_folha < n && (proximo_interno >= novo || nos[proxima_folha].peso <= nos[proximo_interno].peso))
+                escolhidos[k] = proxima_folha++;
+            else
+                escolhidos[k] = proximo_interno++;
+        }
+
+        nos[novo].peso = nos[escolhidos[0]].peso + nos[escolhidos[1]].peso;
+        nos[novo].pai = -1;
+        nos[escolhidos[0]].pai = nos[escolhidos[1]].pai = novo;
+    }
+
+    int ok = profundidades_para_tamanhos(nos, simbolos, n, tamanhos);
+    if(n == 1) tamanhos[simbolos[0]] = 1;
+
+    free(nos);
+    return ok;
+}
+
+#endif
@@ -0,0 +1,526 @@
+/**
+ * @file contexto.h
+ * @brief Modo de ordem 1: o código de cada byte depende do byte anterior (o contexto).
+ *
+ * Cada um dos 256 contextos tem a sua distribuição de bytes, mas uma tabela de códigos por contexto
+ * custaria caro no cabeçalho. Os contextos são agrupados (k-médias sobre o custo em bits): cada grupo
+ * tem uma tabela canônica, gravada como a do formato canônico, e cada contexto guarda só o número do
+ * seu grupo. São testadas 1, 2, 4, ... até MAX_TABELAS_CONTEXTO tabelas e fica a quantidade que gera
+ * o menor arquivo. A decodificação continua sendo por tabela, um símbolo (ou um par) por consulta.
+ *
+ * Formato do arquivo (versão FORMATO_CONTEXTO):
+ * - 2 bytes: assinatura "HF";
+ * - 1 byte: versão do formato;
+ * - 1 byte: tamanho do lixo no último byte dos dados (0 a 7);
+ * - 1 byte: quantidade de tabelas (0 só em arquivos vazios);
+ * - mapa com o número da tabela de cada contexto, empacotado com o menor número de bits possível;
+ * - as tabelas de tamanhos, no formato de salvar_tabela_tamanhos;
+ * - dados codificados. O contexto do primeiro byte é o byte 0.
+ */
+
+#ifndef CONTEXTO_H
+#define CONTEXTO_H
+
+#include "canonico.h"
+
+/**
+ * @def MAX_TABELAS_CONTEXTO
+ * @brief Quantidade máxima de tabelas (grupos de contextos).
+ */
+#define MAX_TABELAS_CONTEXTO 64
+
+/**
+ * @def ITERACOES_CONTEXTO
+ * @brief Quantidade máxima de rodadas do agrupamento dos contextos.
+ */
+#define ITERACOES_CONTEXTO 8
+
+/**
+ * @def CUSTO_IMPOSSIVEL
+ * @brief Custo de codificar um contexto com uma tabela que não tem código para algum dos seus bytes.
+ */
+#define CUSTO_IMPOSSIVEL (~0ULL)
+
+/**
+ * @struct MODELO_CONTEXTO
+ * @brief Tabelas de códigos e o grupo de cada contexto.
+ *
+ * - n_tabelas: quantidade de tabelas.
+ * - mapa: tabela usada por cada contexto (byte anterior).
+ * - tamanhos: tamanho do código de cada byte, em cada tabela.
+ */
+typedef struct{
+    int n_tabelas;
+    unsigned char mapa[TAM_ASCII];
+    unsigned char tamanhos[MAX_TABELAS_CONTEXTO][TAM_ASCII];
+}MODELO_CONTEXTO;
+
+/**
+ * @brief Soma às frequências de ordem 1 os pares (byte anterior, byte) dos dados.
+ *
+ * @param dados Bytes a serem contados.
+ * @param tamanho Quantidade de bytes.
+ * @param anterior Ponteiro para o byte anterior ao primeiro (atualizado com o último byte dos dados).
+ * @param frequencia Matriz 256 x 256, indexada por [contexto][byte], que é acumulada.
+ */
+void contar_contextos(const unsigned char *dados, size_t tamanho, unsigned char *anterior, unsigned long (*frequencia)[TAM_ASCII]){
+    unsigned char contexto = *anterior;
+    for(size_t i = 0; i < tamanho; i++){
+        frequencia[contexto][dados[i]]++;
+        contexto = dados[i];
+    }
+    *anterior = contexto;
+}
+
+/**
+ * @brief Calcula quantos bits um contexto gasta com uma tabela.
+ *
+ * @param frequencia Frequência de cada byte no contexto.
+ * @param tamanhos Tamanhos dos códigos da tabela.
+ * @return unsigned long long Total de bits ou CUSTO_IMPOSSIVEL se faltar código para algum byte.
+ */
+unsigned long long custo_contexto(const unsigned long *frequencia, const unsigned char *tamanhos){
+    unsigned long long total = 0;
+    for(int i = 0; i < TAM_ASCII; i++){
+        if(frequencia[i] == 0) continue;
+        if(tamanhos[i] == 0) return CUSTO_IMPOSSIVEL;
+        total += (unsigned long long)frequencia[i] * tamanhos[i];
+    }
+    return total;
+}
+
+/**
+ * @brief Recalcula os códigos de cada tabela a partir dos contextos que estão no seu grupo.
+ *
+ * @param modelo Ponteiro para o modelo.
+ * @param frequencia Frequências de ordem 1.
+ * @param ocorrencias Quantidade de bytes em cada contexto.
+ * @return int 1 em caso de sucesso ou 0 se não foi possível calcular os códigos.
+ */
+int ajustar_tabelas(MODELO_CONTEXTO *modelo, unsigned long (*frequencia)[TAM_ASCII], const unsigned long long *ocorrencias){
+    for(int t = 0; t < modelo->n_tabelas; t++){
+        unsigned long soma[TAM_ASCII] = {0};
+        int vazio = 1;
+
+        for(int c = 0; c < TAM_ASCII; c++){
+            if(modelo->mapa[c] != t || ocorrencias[c] == 0) continue;
+            for(int i = 0; i < TAM_ASCII; i++)
+                soma[i] += frequencia[c][i];
+            vazio = 0;
+        }
+
+        if(vazio)
+            memset(modelo->tamanhos[t], 0, TAM_ASCII);
+        else if(!escolher_tamanhos(soma, 0, modelo->tamanhos[t]))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Calcula o tamanho, em bytes, do cabeçalho de ordem 1.
+ *
+ * @param modelo Ponteiro para o modelo.
+ * @param largura_mapa Ponteiro para guardar a quantidade de bits de cada posição do mapa.
+ * @return unsigned long Tamanho do cabeçalho em bytes.
+ */
+unsigned long tamanho_cabecalho_contexto(const MODELO_CONTEXTO *modelo, int *largura_mapa){
+    *largura_mapa = 0;
+    while((1 << *largura_mapa) < modelo->n_tabelas)
+        (*largura_mapa)++;
+
+    unsigned long total = 5 + (TAM_ASCII * *largura_mapa + 7) / 8;
+    for(int t = 0; t < modelo->n_tabelas; t++){
+        int largura, presentes;
+        total += tamanho_tabela_tamanhos(modelo->tamanhos[t], &largura, &presentes);
+    }
+    return total;
+}
+
+/**
+ * @brief Agrupa os contextos em até n_tabelas tabelas.
+ *
+ * A tabela 0 começa com todos os contextos e as demais com os contextos mais frequentes, um em cada.
+ * A cada rodada, cada contexto vai para a tabela que o codifica com menos bits e as tabelas são
+ * recalculadas; no fim, as tabelas que ficaram sem contextos são descartadas.
+ *
+ * @param modelo Ponteiro para o modelo a ser preenchido.
+ * @param frequencia Frequências de ordem 1.
+ * @param ocorrencias Quantidade de bytes em cada contexto.
+ * @param n_tabelas Quantidade máxima de tabelas.
+ * @return unsigned long long Tamanho estimado do arquivo (cabeçalho e dados) ou CUSTO_IMPOSSIVEL em caso de erro.
+ */
+unsigned long long agrupar_contextos(MODELO_CONTEXTO *modelo, unsigned long (*frequencia)[TAM_ASCII], const unsigned long long *ocorrencias, int n_tabelas){
+    memset(modelo->mapa, 0, TAM_ASCII);
+    modelo->n_tabelas = 1;
+
+    // Sementes: os contextos mais frequentes ganham uma tabela própria
+    while(modelo->n_tabelas < n_tabelas){
+        int maior = -1;
+        for(int c = 0; c < TAM_ASCII; c++)
+            if(modelo->mapa[c] == 0 && ocorrencias[c] > 0 && (maior < 0 || ocorrencias[c] > ocorrencias[maior]))
+                maior = c;
+        if(maior < 0) break;
+        modelo->mapa[maior] = modelo->n_tabelas++;
+    }
+
+    if(!ajustar_tabelas(modelo, frequencia, ocorrencias))
+        return CUSTO_IMPOSSIVEL;
+
+    for(int rodada = 0; rodada < ITERACOES_CONTEXTO; rodada++){
+        int mudou = 0;
+
+        for(int c = 0; c < TAM_ASCII; c++){
+            if(ocorrencias[c] == 0) continue;
+
+            int melhor = modelo->mapa[c];
+            unsigned long long menor = custo_contexto(frequencia[c], modelo->tamanhos[melhor]);
+            for(int t = 0; t < modelo->n_tabelas; t++){
+                unsigned long long custo = custo_contexto(frequencia[c], modelo->tamanhos[t]);
+                if(custo < menor){
+                    menor = custo;
+                    melhor = t;
+                }
+            }
+
+            if(melhor != modelo->mapa[c]){
+                modelo->mapa[c] = melhor;
+                mudou = 1;
+            }
+        }
+
+        if(!mudou) break;
+        if(!ajustar_tabelas(modelo, frequencia, ocorrencias))
+            return CUSTO_IMPOSSIVEL;
+    }
+
+    // Descarta as tabelas vazias e renumera as restantes
+    int novo[MAX_TABELAS_CONTEXTO], usadas = 0;
+    for(int t = 0; t < modelo->n_tabelas; t++){
+        novo[t] = -1;
+        for(int c = 0; c < TAM_ASCII && novo[t] < 0; c++)
+            if(modelo->mapa[c] == t && ocorrencias[c] > 0) novo[t] = usadas;
+        if(novo[t] < 0) continue;
+
+        if(usadas != t) memcpy(modelo->tamanhos[usadas], modelo->tamanhos[t], TAM_ASCII);
+        usadas++;
+    }
+    for(int c = 0; c < TAM_ASCII; c++)
+        modelo->mapa[c] = ocorrencias[c] > 0 ? novo[modelo->mapa[c]] : 0;
+    modelo->n_tabelas = usadas;
+
+    unsigned long long bits = 0;
+    for(int c = 0; c < TAM_ASCII; c++)
+        if(ocorrencias[c] > 0) bits += custo_contexto(frequencia[c], modelo->tamanhos[modelo->mapa[c]]);
+
+    int largura_mapa;
+    return tamanho_cabecalho_contexto(modelo, &largura_mapa) + (bits + 7) / 8;
+}
+
+/**
+ * @brief Escolhe a quantidade de tabelas que gera o menor arquivo e monta o modelo.
+ *
+ * @param modelo Ponteiro para o modelo a ser preenchido.
+ * @param frequencia Frequências de ordem 1.
+ * @return int 1 em caso de sucesso ou 0 se não foi possível calcular os códigos.
+ */
+int escolher_modelo_contexto(MODELO_CONTEXTO *modelo, unsigned long (*frequencia)[TAM_ASCII]){
+    unsigned long long ocorrencias[TAM_ASCII] = {0};
+    int vazio = 1;
+
+    for(int c = 0; c < TAM_ASCII; c++){
+        for(int i = 0; i < TAM_ASCII; i++)
+            ocorrencias[c] += frequencia[c][i];
+        if(ocorrencias[c] > 0) vazio = 0;
+    }
+
+    if(vazio){
+        memset(modelo->mapa, 0, TAM_ASCII);
+        modelo->n_tabelas = 0;
+        return 1;
+    }
+
+    MODELO_CONTEXTO *tentativa = malloc(sizeof(MODELO_CONTEXTO));
+    if(!tentativa) return 0;
+
+    unsigned long long menor = CUSTO_IMPOSSIVEL;
+    for(int n = 1; n <= MAX_TABELAS_CONTEXTO; n *= 2){
+        unsigned long long custo = agrupar_contextos(tentativa, frequencia, ocorrencias, n);
+        if(custo < menor){
+            menor = custo;
+            *modelo = *tentativa;
+        }
+        // Com menos contextos do que tabelas, as próximas tentativas dariam o mesmo resultado
+        if(tentativa->n_tabelas < n) break;
+    }
+
+    free(tentativa);
+    return menor != CUSTO_IMPOSSIVEL;
+}
+
+/**
+ * @brief Escreve o cabeçalho de ordem 1.
+ *
+ * @param escritor Escritor de saída.
+ * @param modelo Ponteiro para o modelo.
+ * @param lixo Quantidade de bits de lixo no último byte dos dados.
+ * @return unsigned long Tamanho do cabeçalho em bytes.
+ */
+unsigned long salvar_cabecalho_contexto(ESCRITOR *escritor, const MODELO_CONTEXTO *modelo, int lixo){
+    int largura_mapa;
+    unsigned long tam_cabecalho = tamanho_cabecalho_contexto(modelo, &largura_mapa);
+
+    escrever_bytes(escritor, (const unsigned char*)ASSINATURA, 2);
+    escrever_byte(escritor, FORMATO_CONTEXTO);
+    escrever_byte(escritor, lixo);
+    escrever_byte(escritor, modelo->n_tabelas);
+
+    if(largura_mapa > 0){
+        ESCRITOR_BITS escritor_bits;
+        iniciar_escritor_bits(&escritor_bits, escritor);
+        for(int c = 0; c < TAM_ASCII; c++)
+            escrever_bits(&escritor_bits, modelo->mapa[c], largura_mapa);
+        finalizar_bits(&escritor_bits);
+    }
+
+    for(int t = 0; t < modelo->n_tabelas; t++)
+        salvar_tabela_tamanhos(escritor, modelo->tamanhos[t]);
+
+    return tam_cabecalho;
+}
+
+/**
+ * @brief Lê o cabeçalho de ordem 1 logo depois da assinatura e da versão.
+ *
+ * @param leitor Leitor posicionado no byte de lixo.
+ * @param modelo Ponteiro para o modelo a ser preenchido.
+ * @param lixo Ponteiro para guardar a quantidade de bits de lixo.
+ * @return long Tamanho total do cabeçalho em bytes ou -1 se ele for inválido.
+ */
+long ler_cabecalho_contexto(LEITOR *leitor, MODELO_CONTEXTO *modelo, int *lixo){
+    unsigned char campos[2];
+    if(ler_bytes(leitor, campos, 2) != 2 || campos[0] > 7 || campos[1] > MAX_TABELAS_CONTEXTO)
+        return -1;
+
+    *lixo = campos[0];
+    modelo->n_tabelas = campos[1];
+
+    int largura_mapa = 0;
+    while((1 << largura_mapa) < modelo->n_tabelas)
+        largura_mapa++;
+
+    memset(modelo->mapa, 0, TAM_ASCII);
+    if(largura_mapa > 0){
+        LEITOR_BITS leitor_bits;
+        unsigned char byte;
+        iniciar_leitor_bits(&leitor_bits, leitor);
+
+        for(int c = 0; c < TAM_ASCII; c++){
+            if(leitor_bits.quantidade < largura_mapa){
+                if(!ler_byte(leitor, &byte)) return -1;
+                leitor_bits.acumulador |= (unsigned long long)byte << (56 - leitor_bits.quantidade);
+                leitor_bits.quantidade += 8;
+            }
+            modelo->mapa[c] = espiar_bits(&leitor_bits, largura_mapa);
+            consumir_bits(&leitor_bits, largura_mapa);
+            if(modelo->mapa[c] >= modelo->n_tabelas) return -1;
+        }
+    }
+
+    for(int t = 0; t < modelo->n_tabelas; t++)
+        if(ler_tabela_tamanhos(leitor, modelo->tamanhos[t]) < 0) return -1;
+
+    return tamanho_cabecalho_contexto(modelo, &largura_mapa);
+}
+
+/**
+ * @brief Codifica no modo de ordem 1 os dados de um leitor, em duas passadas (contagem e codificação).
+ *
+ * @param leitor Leitor posicionado no início dos dados originais (é reiniciado depois da contagem).
+ * @param escritor Escritor de saída.
+ * @param tam_arq Quantidade de bytes a codificar.
+ * @param n_tabelas Ponteiro para guardar a quantidade de tabelas escolhida (pode ser NULL).
+ * @return long Tamanho do cabeçalho em bytes ou -1 em caso de erro.
+ */
+long codificar_contexto_leitor(LEITOR *leitor, ESCRITOR *escritor, unsigned long tam_arq, int *n_tabelas){
+    unsigned long (*frequencia)[TAM_ASCII] = calloc(TAM_ASCII, sizeof(*frequencia));
+    MODELO_CONTEXTO *modelo = malloc(sizeof(MODELO_CONTEXTO));
+    if(!frequencia || !modelo){
+        free(frequencia);
+        free(modelo);
+        return -1;
+    }
+
+    unsigned char anterior = 0;
+    unsigned long restante = tam_arq;
+    while(restante > 0 && recarregar_leitor(leitor) > 0){
+        size_t n = leitor->tamanho < restante ? leitor->tamanho : restante;
+        contar_contextos(leitor->dados, n, &anterior, frequencia);
+        restante -= n;
+    }
+    reiniciar_leitor(leitor);
+
+    if(!escolher_modelo_contexto(modelo, frequencia)){
+        free(frequencia);
+        free(modelo);
+        return -1;
+    }
+
+    CODIGO (*codigos)[TAM_ASCII] = malloc((modelo->n_tabelas > 0 ? modelo->n_tabelas : 1) * sizeof(*codigos));
+    if(!codigos){
+        free(frequencia);
+        free(modelo);
+        return -1;
+    }
+
+    unsigned long long total_bits = 0;
+    for(int c = 0; c < TAM_ASCII; c++)
+        total_bits += contar_bits(frequencia[c], modelo->tamanhos[modelo->mapa[c]], TAM_ASCII);
+    free(frequencia);
+
+    const CODIGO *por_contexto[TAM_ASCII];
+    for(int t = 0; t < modelo->n_tabelas; t++)
+        gerar_codigos_canonicos(modelo->tamanhos[t], codigos[t], TAM_ASCII);
+    for(int c = 0; c < TAM_ASCII; c++)
+        por_contexto[c] = codigos[modelo->mapa[c]];
+
+    long tam_cabecalho = salvar_cabecalho_contexto(escritor, modelo, (8 - total_bits % 8) % 8);
+    if(n_tabelas) *n_tabelas = modelo->n_tabelas;
+
+    ESCRITOR_BITS escritor_bits;
+    iniciar_escritor_bits(&escritor_bits, escritor);
+
+    anterior = 0;
+    restante = tam_arq;
+    while(restante > 0 && recarregar_leitor(leitor) > 0){
+        size_t n = leitor->tamanho < restante ? leitor->tamanho : restante;
+        for(size_t i = 0; i < n; i++){
+            const CODIGO *codigo = &por_contexto[anterior][leitor->dados[i]];
+            escrever_bits(&escritor_bits, codigo->bits, codigo->tamanho);
+            anterior = leitor->dados[i];
+        }
+        restante -= n;
+    }
+    finalizar_bits(&escritor_bits);
+
+    free(codigos);
+    free(modelo);
+    return escritor->erro ? -1 : tam_cabecalho;
+}
+
+/**
+ * @brief Compacta um arquivo no modo de ordem 1.
+ *
+ * @param leitor Leitor do arquivo original, posicionado no início.
+ * @param arquivo_saida Arquivo de saída.
+ * @param tam_arq Tamanho do arquivo original.
+ * @param tam_bloco Tamanho dos blocos de escrita (0 usa TAM_BLOCO_IO).
+ * @param n_tabelas Ponteiro para guardar a quantidade de tabelas escolhida (pode ser NULL).
+ * @return long Tamanho do cabeçalho em bytes ou -1 em caso de erro.
+ */
+long codificar_contexto(LEITOR *leitor, FILE *arquivo_saida, unsigned long tam_arq, size_t tam_bloco, int *n_tabelas){
+    ESCRITOR escritor;
+    if(!iniciar_escritor(&escritor, arquivo_saida, tam_bloco))
+        return -1;
+
+    long tam_cabecalho = codificar_contexto_leitor(leitor, &escritor, tam_arq, n_tabelas);
+
+    liberar_escritor(&escritor);
+    return escritor.erro ? -1 : tam_cabecalho;
+}
+
+/**
+ * @brief Decodifica dados no modo de ordem 1 de um leitor (arquivo ou memória).
+ *
+ * A cada símbolo a tabela é trocada pela do contexto; um par de símbolos da tabela principal só é
+ * aproveitado quando o contexto do segundo usa a mesma tabela.
+ *
+ * @param leitor Leitor posicionado logo depois da assinatura e da versão.
+ * @param escritor Escritor de saída.
+ * @param tam_comprimido Tamanho total dos dados compactados, contando assinatura e versão.
+ * @return int 1 em caso de sucesso ou 0 se os dados forem inválidos.
+ */
+int decodificar_contexto_leitor(LEITOR *leitor, ESCRITOR *escritor, unsigned long tam_comprimido){
+    MODELO_CONTEXTO *modelo = malloc(sizeof(MODELO_CONTEXTO));
+    if(!modelo) return 0;
+
+    int lixo;
+    long tam_cabecalho = ler_cabecalho_contexto(leitor, modelo, &lixo);
+    if(tam_cabecalho < 0 || (unsigned long)tam_cabecalho > tam_comprimido || tam_comprimido - tam_cabecalho < (lixo > 0)){
+        free(modelo);
+        return 0;
+    }
+
+    unsigned long long restante = (unsigned long long)(tam_comprimido - tam_cabecalho) * 8 - lixo;
+    if(modelo->n_tabelas == 0){
+        free(modelo);
+        return restante == 0;
+    }
+
+    TABELA_DECODIFICACAO tabelas[MAX_TABELAS_CONTEXTO];
+    int construidas = 0, ok = 1;
+    for(; construidas < modelo->n_tabelas && ok; construidas++){
+        CODIGO codigos[TAM_ASCII];
+        gerar_codigos_canonicos(modelo->tamanhos[construidas], codigos, TAM_ASCII);
+        ok = construir_tabela(&tabelas[construidas], codigos, TAM_ASCII);
+    }
+    if(!ok) construidas--;
+
+    const TABELA_DECODIFICACAO *por_contexto[TAM_ASCII];
+    for(int c = 0; c < TAM_ASCII; c++)
+        por_contexto[c] = &tabelas[modelo->mapa[c]];
+
+    LEITOR_BITS leitor_bits;
+    iniciar_leitor_bits(&leitor_bits, leitor);
+    unsigned char anterior = 0;
+
+    while(ok && restante > 0){
+        const TABELA_DECODIFICACAO *tabela = por_contexto[anterior];
+        completar_bits(&leitor_bits);
+        const ENTRADA_TABELA *entrada = &tabela->entradas[espiar_bits(&leitor_bits, tabela->bits_raiz)];
+
+        if(entrada->quantidade == 2 && entrada->bits <= restante && por_contexto[entrada->simbolos[0]] == tabela){
+            escrever_byte(escritor, entrada->simbolos[0]);
+            escrever_byte(escritor, entrada->simbolos[1]);
+            consumir_bits(&leitor_bits, entrada->bits);
+            restante -= entrada->bits;
+            anterior = entrada->simbolos[1];
+            continue;
+        }
+
+        int simbolo = decodificar_simbolo(tabela, &leitor_bits, &restante);
+        if(simbolo < 0){
+            ok = 0;
+            break;
+        }
+        escrever_byte(escritor, simbolo);
+        anterior = simbolo;
+    }
+
+    for(int t = 0; t < construidas; t++)
+        liberar_tabela(&tabelas[t]);
+    free(modelo);
+    return ok && !escritor->erro;
+}
+
+/**
+ * @brief Descompacta um arquivo no modo de ordem 1.
+ *
+ * @param leitor Leitor do arquivo compactado, posicionado logo depois da assinatura e da versão.
+ * @param arquivo_saida Arquivo de saída.
+ * @param tam_arq Tamanho total do arquivo compactado.
+ * @param tam_bloco Tamanho dos blocos de escrita (0 usa TAM_BLOCO_IO).
+ * @return int 1 em caso de sucesso ou 0 se o arquivo for inválido.
+ */
+int decodificar_contexto(LEITOR *leitor, FILE *arquivo_saida, unsigned long tam_arq, size_t tam_bloco){
+    ESCRITOR escritor;
+    if(!iniciar_escritor(&escritor, arquivo_saida, tam_bloco))
+        return 0;
+
+    int ok = decodificar_contexto_leitor(leitor, &escritor, tam_arq);
+
+    liberar_escritor(&escritor);
+    return ok && !escritor.erro;
+}
+
+#endif
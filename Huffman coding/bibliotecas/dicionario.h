@@ -0,0 +1,280 @@
+/**
+ * @file dicionario.h
+ * @brief Dicionários: tabelas de Huffman treinadas com amostras e compartilhadas por várias mensagens.
+ *
+ * Em mensagens pequenas, o cabeçalho com a árvore (ou com os tamanhos dos códigos) custa mais do
+ * que a compactação economiza. O dicionário é treinado uma vez com um corpus de exemplo e gravado
+ * em um arquivo; depois, cada mensagem é compactada e descompactada com ele, sem cabeçalho próprio.
+ * Todos os 256 bytes recebem um código no treino, mesmo os que não aparecem nas amostras, então
+ * qualquer mensagem pode ser compactada.
+ *
+ * Formato do arquivo de dicionário (versão FORMATO_DICIONARIO):
+ * - 2 bytes: assinatura "HF";
+ * - 1 byte: versão do formato;
+ * - 4 bytes: identificador do dicionário;
+ * - 256 bytes: tamanho do código de cada byte.
+ *
+ * Formato de uma mensagem (versão FORMATO_COM_DICIONARIO):
+ * - 2 bytes: assinatura "HF";
+ * - 1 byte: versão do formato;
+ * - 1 byte: tamanho do lixo no último byte dos dados (0 a 7);
+ * - 4 bytes: identificador do dicionário usado;
+ * - dados codificados.
+ */
+
+#ifndef DICIONARIO_H
+#define DICIONARIO_H
+
+#include "memoria.h"
+
+/**
+ * @def BITS_DICIONARIO
+ * @brief Tamanho máximo padrão dos códigos de um dicionário.
+ *
+ * Os bytes que não aparecem nas amostras ganham os códigos mais longos; o limite evita que eles
+ * expandam demais as mensagens que os contêm.
+ */
+#define BITS_DICIONARIO 15
+
+/**
+ * @def MAX_BITS_DICIONARIO
+ * @brief Maior tamanho de código aceito em um dicionário.
+ */
+#define MAX_BITS_DICIONARIO 32
+
+/**
+ * @def TAM_CABECALHO_DICIONARIO
+ * @brief Tamanho, em bytes, do cabeçalho de uma mensagem compactada com dicionário.
+ */
+#define TAM_CABECALHO_DICIONARIO 8
+
+/**
+ * @struct DICIONARIO
+ * @brief Tabela de Huffman compartilhada, pronta para compactar e descompactar.
+ *
+ * - tamanhos: tamanho do código de cada byte.
+ * - codigos: códigos canônicos gerados a partir dos tamanhos.
+ * - tabela: tabela de decodificação dos códigos.
+ * - identificador: resumo dos tamanhos, gravado nas mensagens para detectar o dicionário errado.
+ */
+typedef struct{
+    unsigned char tamanhos[TAM_ASCII];
+    CODIGO codigos[TAM_ASCII];
+    TABELA_DECODIFICACAO tabela;
+    unsigned long identificador;
+}DICIONARIO;
+
+/**
+ * @brief Calcula o identificador de um dicionário (FNV-1a de 32 bits sobre os tamanhos).
+ *
+ * @param tamanhos Tamanho do código de cada byte.
+ * @return unsigned long Identificador.
+ */
+unsigned long identificar_dicionario(const unsigned char *tamanhos){
+    unsigned long resumo = 2166136261UL;
+    for(int i = 0; i < TAM_ASCII; i++){
+        resumo ^= tamanhos[i];
+        resumo = (resumo * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return resumo;
+}
+
+/**
+ * @brief Gera os códigos, a tabela de decodificação e o identificador a partir dos tamanhos.
+ *
+ * @param dicionario Ponteiro para o dicionário, com os tamanhos já preenchidos.
+ * @return int 1 em caso de sucesso ou 0 se faltar memória.
+ */
+int preparar_dicionario(DICIONARIO *dicionario){
+    gerar_codigos_canonicos(dicionario->tamanhos, dicionario->codigos, TAM_ASCII);
+    dicionario->identificador = identificar_dicionario(dicionario->tamanhos);
+    return construir_tabela(&dicionario->tabela, dicionario->codigos, TAM_ASCII);
+}
+
+/**
+ * @brief Treina um dicionário com a frequência dos bytes de um corpus de exemplo.
+ *
+ * A frequência de cada byte é somada de 1, para que todos os bytes tenham código.
+ *
+ * @param dicionario Ponteiro para o dicionário a ser criado.
+ * @param frequencia Frequência de cada byte nas amostras (histograma acumulado de todas elas).
+ * @param max_bits Tamanho máximo dos códigos, de 8 a MAX_BITS_DICIONARIO (0 usa BITS_DICIONARIO).
+ * @return int 1 em caso de sucesso ou 0 se o limite for inválido ou faltar memória.
+ */
+int treinar_dicionario(DICIONARIO *dicionario, const unsigned long *frequencia, int max_bits){
+    unsigned long suavizada[TAM_ASCII];
+
+    if(max_bits == 0) max_bits = BITS_DICIONARIO;
+    if(max_bits < 8 || max_bits > MAX_BITS_DICIONARIO)
+        return 0;
+
+    for(int i = 0; i < TAM_ASCII; i++)
+        suavizada[i] = frequencia[i] < (unsigned long)-1 ? frequencia[i] + 1 : frequencia[i];
+
+    if(!escolher_tamanhos(suavizada, max_bits, dicionario->tamanhos))
+        return 0;
+    return preparar_dicionario(dicionario);
+}
+
+/**
+ * @brief Grava um dicionário em um arquivo.
+ *
+ * @param dicionario Ponteiro para o dicionário.
+ * @param arquivo Arquivo aberto em modo binário para escrita.
+ * @return int 1 em caso de sucesso ou 0 se a escrita falhou.
+ */
+int salvar_dicionario(const DICIONARIO *dicionario, FILE *arquivo){
+    unsigned char cabecalho[7] = {ASSINATURA[0], ASSINATURA[1], FORMATO_DICIONARIO};
+    gravar_u32(cabecalho + 3, dicionario->identificador);
+
+    return fwrite(cabecalho, 1, 7, arquivo) == 7 && fwrite(dicionario->tamanhos, 1, TAM_ASCII, arquivo) == TAM_ASCII;
+}
+
+/**
+ * @brief Lê um dicionário gravado por salvar_dicionario.
+ *
+ * Os tamanhos precisam formar um código de prefixo completo com os 256 bytes, e o identificador
+ * gravado precisa conferir com eles.
+ *
+ * @param dicionario Ponteiro para o dicionário a ser preenchido (liberado depois por liberar_dicionario).
+ * @param arquivo Arquivo aberto em modo binário, posicionado no início.
+ * @return int 1 em caso de sucesso ou 0 se o arquivo for inválido ou faltar memória.
+ */
+int carregar_dicionario(DICIONARIO *dicionario, FILE *arquivo){
+    unsigned char cabecalho[7];
+    if(fread(cabecalho, 1, 7, arquivo) != 7 || memcmp(cabecalho, ASSINATURA, 2) != 0 || cabecalho[2] != FORMATO_DICIONARIO)
+        return 0;
+    if(fread(dicionario->tamanhos, 1, TAM_ASCII, arquivo) != TAM_ASCII)
+        return 0;
+
+    // Soma de Kraft: com todos os tamanhos até MAX_BITS_DICIONARIO, um código completo soma 2^32
+    unsigned long long kraft = 0;
+    for(int i = 0; i < TAM_ASCII; i++){
+        if(dicionario->tamanhos[i] == 0 || dicionario->tamanhos[i] > MAX_BITS_DICIONARIO)
+            return 0;
+        kraft += 1ULL << (MAX_BITS_DICIONARIO - dicionario->tamanhos[i]);
+    }
+    if(kraft != 1ULL << MAX_BITS_DICIONARIO)
+        return 0;
+
+    unsigned long identificador = extrair_u32(cabecalho + 3);
+    if(identificar_dicionario(dicionario->tamanhos) != identificador)
+        return 0;
+
+    return preparar_dicionario(dicionario);
+}
+
+/**
+ * @brief Libera a tabela de decodificação do dicionário.
+ *
+ * @param dicionario Ponteiro para o dicionário.
+ */
+void liberar_dicionario(DICIONARIO *dicionario){
+    liberar_tabela(&dicionario->tabela);
+}
+
+/**
+ * @brief Retorna o maior tamanho possível de uma mensagem compactada com o dicionário.
+ *
+ * @param dicionario Ponteiro para o dicionário.
+ * @param tam_original Tamanho da mensagem original.
+ * @return size_t Capacidade que garante que a mensagem compactada cabe na saída.
+ */
+size_t limite_com_dicionario(const DICIONARIO *dicionario, size_t tam_original){
+    int maior = 0;
+    for(int i = 0; i < TAM_ASCII; i++)
+        if(dicionario->tamanhos[i] > maior) maior = dicionario->tamanhos[i];
+
+    return TAM_CABECALHO_DICIONARIO + (tam_original / 8) * maior + ((tam_original % 8) * maior + 7) / 8;
+}
+
+/**
+ * @brief Retorna o maior tamanho possível de uma mensagem descompactada com o dicionário.
+ *
+ * @param dicionario Ponteiro para o dicionário.
+ * @param tam_compactado Tamanho da mensagem compactada.
+ * @return size_t Capacidade que garante que a mensagem descompactada cabe na saída.
+ */
+size_t limite_descompactado_dicionario(const DICIONARIO *dicionario, size_t tam_compactado){
+    int menor = MAX_BITS_DICIONARIO;
+    for(int i = 0; i < TAM_ASCII; i++)
+        if(dicionario->tamanhos[i] < menor) menor = dicionario->tamanhos[i];
+
+    if(tam_compactado < TAM_CABECALHO_DICIONARIO) return 0;
+    return (unsigned long long)(tam_compactado - TAM_CABECALHO_DICIONARIO) * 8 / menor;
+}
+
+/**
+ * @brief Compacta uma mensagem com o dicionário.
+ *
+ * @param dicionario Ponteiro para o dicionário.
+ * @param origem Mensagem original.
+ * @param tam_origem Tamanho da mensagem original.
+ * @param destino Região de saída.
+ * @param capacidade Tamanho da região de saída (limite_com_dicionario sempre basta).
+ * @return long long Tamanho da mensagem compactada ou -1 se a saída não couber.
+ */
+long long compactar_com_dicionario(const DICIONARIO *dicionario, const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade){
+    if(capacidade < TAM_CABECALHO_DICIONARIO || (capacidade == TAM_CABECALHO_DICIONARIO && tam_origem > 0))
+        return -1;
+
+    ESCRITOR escritor;
+    iniciar_escritor_memoria(&escritor, destino + TAM_CABECALHO_DICIONARIO, capacidade - TAM_CABECALHO_DICIONARIO);
+
+    ESCRITOR_BITS escritor_bits;
+    iniciar_escritor_bits(&escritor_bits, &escritor);
+
+    unsigned long long total_bits = 0;
+    for(size_t i = 0; i < tam_origem; i++){
+        const CODIGO *codigo = &dicionario->codigos[origem[i]];
+        escrever_bits(&escritor_bits, codigo->bits, codigo->tamanho);
+        total_bits += codigo->tamanho;
+    }
+    finalizar_bits(&escritor_bits);
+    if(escritor.erro) return -1;
+
+    memcpy(destino, ASSINATURA, 2);
+    destino[2] = FORMATO_COM_DICIONARIO;
+    destino[3] = (8 - total_bits % 8) % 8;
+    gravar_u32(destino + 4, dicionario->identificador);
+
+    return TAM_CABECALHO_DICIONARIO + escritor.tamanho;
+}
+
+/**
+ * @brief Descompacta uma mensagem compactada com o dicionário.
+ *
+ * @param dicionario Ponteiro para o dicionário usado na compactação.
+ * @param origem Mensagem compactada.
+ * @param tam_origem Tamanho da mensagem compactada.
+ * @param destino Região de saída.
+ * @param capacidade Tamanho da região de saída (limite_descompactado_dicionario sempre basta).
+ * @return long long Tamanho da mensagem original ou -1 se ela for inválida, tiver sido compactada com
+ * outro dicionário ou não couber na saída.
+ */
+long long descompactar_com_dicionario(const DICIONARIO *dicionario, const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade){
+    if(tam_origem < TAM_CABECALHO_DICIONARIO || memcmp(origem, ASSINATURA, 2) != 0 || origem[2] != FORMATO_COM_DICIONARIO)
+        return -1;
+    if(origem[3] > 7 || extrair_u32(origem + 4) != dicionario->identificador)
+        return -1;
+
+    unsigned long long total_bits = (unsigned long long)(tam_origem - TAM_CABECALHO_DICIONARIO) * 8;
+    if(total_bits < origem[3])
+        return -1;
+    total_bits -= origem[3];
+    if(total_bits > 0 && capacidade == 0)
+        return -1;
+
+    LEITOR leitor;
+    ESCRITOR escritor;
+    LEITOR_BITS leitor_bits;
+    iniciar_leitor_memoria(&leitor, origem + TAM_CABECALHO_DICIONARIO, tam_origem - TAM_CABECALHO_DICIONARIO);
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+    iniciar_leitor_bits(&leitor_bits, &leitor);
+
+    if(!decodificar_com_tabela(&dicionario->tabela, &leitor_bits, total_bits, &escritor) || escritor.erro)
+        return -1;
+    return escritor.tamanho;
+}
+
+#endif
@@ -0,0 +1,295 @@
+/**
+ * @file fluxos.h
+ * @brief Blocos canônicos divididos em quatro fluxos de bits, decodificados em um único laço.
+ *
+ * Em um fluxo só, cada consulta à tabela depende do tamanho do código anterior, então o
+ * processador não consegue adiantar a próxima. Aqui o bloco é dividido em quatro trechos
+ * contíguos, cada um codificado em um fluxo próprio com os mesmos códigos; o decodificador alterna
+ * entre os quatro, e as consultas de fluxos diferentes, independentes entre si, se sobrepõem.
+ *
+ * Formato do bloco (versão FORMATO_QUATRO_FLUXOS):
+ * - 2 bytes: assinatura "HF";
+ * - 1 byte: versão do formato;
+ * - tabela de tamanhos dos códigos (a mesma do formato canônico, sem o byte de lixo);
+ * - 3 x 4 bytes: tamanho, em bytes, dos três primeiros fluxos (o quarto vai até o fim do bloco);
+ * - os quatro fluxos, cada um completado com zeros até o fim do último byte.
+ *
+ * Os três primeiros trechos têm tam_original / 4 bytes e o quarto fica com o resto. O tamanho
+ * original não é gravado: ele vem do índice do bloco.
+ */
+
+#ifndef FLUXOS_H
+#define FLUXOS_H
+
+#include "canonico.h"
+#include "histograma.h"
+
+/**
+ * @def N_FLUXOS
+ * @brief Quantidade de fluxos de bits por bloco.
+ */
+#define N_FLUXOS 4
+
+/**
+ * @struct FLUXO_BITS
+ * @brief Leitor de bits direto da memória, com o acumulador alinhado à esquerda como o LEITOR_BITS.
+ *
+ * - posicao: próximo byte ainda não colocado no acumulador.
+ * - fim: posição seguinte ao último byte do fluxo.
+ * - acumulador: bits ainda não consumidos, o próximo bit fica no bit mais significativo.
+ * - quantidade: quantidade de bits válidos no acumulador.
+ * - extras: bytes zerados colocados no acumulador depois do fim do fluxo.
+ */
+typedef struct{
+    const unsigned char *posicao;
+    const unsigned char *fim;
+    unsigned long long acumulador;
+    int quantidade;
+    long extras;
+}FLUXO_BITS;
+
+/**
+ * @brief Inicia um leitor de bits sobre um fluxo em memória.
+ *
+ * @param fluxo Ponteiro para o leitor.
+ * @param dados Primeiro byte do fluxo.
+ * @param tamanho Quantidade de bytes do fluxo.
+ */
+void iniciar_fluxo(FLUXO_BITS *fluxo, const unsigned char *dados, size_t tamanho){
+    fluxo->posicao = dados;
+    fluxo->fim = dados + tamanho;
+    fluxo->acumulador = 0;
+    fluxo->quantidade = 0;
+    fluxo->extras = 0;
+}
+
+/**
+ * @brief Completa o acumulador até ter pelo menos 56 bits válidos.
+ *
+ * Longe do fim, lê 8 bytes de uma vez sem laço: os bits que passam do que foi contado são os
+ * próprios bits seguintes do fluxo e são gravados de novo, iguais, na próxima vez. Perto do fim,
+ * lê byte a byte e completa com zeros.
+ *
+ * @param fluxo Ponteiro para o leitor.
+ */
+static inline void completar_fluxo(FLUXO_BITS *fluxo){
+    if(fluxo->fim - fluxo->posicao >= 8){
+        const unsigned char *p = fluxo->posicao;
+        unsigned long long palavra = ((unsigned long long)p[0] << 56) | ((unsigned long long)p[1] << 48) |
+                                     ((unsigned long long)p[2] << 40) | ((unsigned long long)p[3] << 32) |
+                                     ((unsigned long long)p[4] << 24) | ((unsigned long long)p[5] << 16) |
+                                     ((unsigned long long)p[6] << 8) | (unsigned long long)p[7];
+        int bytes = (63 - fluxo->quantidade) >> 3;
+
+        fluxo->acumulador |= palavra >> fluxo->quantidade;
+        fluxo->posicao += bytes;
+        fluxo->quantidade += bytes << 3;
+        return;
+    }
+
+    while(fluxo->quantidade <= 56){
+        if(fluxo->posicao < fluxo->fim)
+            fluxo->acumulador |= (unsigned long long)*fluxo->posicao++ << (56 - fluxo->quantidade);
+        else
+            fluxo->extras++;
+        fluxo->quantidade += 8;
+    }
+}
+
+/**
+ * @brief Decodifica um único símbolo de um fluxo, descendo pelas tabelas secundárias se preciso.
+ *
+ * @param tabela Ponteiro para a tabela.
+ * @param fluxo Ponteiro para o leitor do fluxo.
+ * @return int O símbolo decodificado ou -1 se o código for inválido.
+ */
+int decodificar_simbolo_fluxo(const TABELA_DECODIFICACAO *tabela, FLUXO_BITS *fluxo){
+    completar_fluxo(fluxo);
+    const ENTRADA_TABELA *entrada = &tabela->entradas[fluxo->acumulador >> (64 - tabela->bits_raiz)];
+    int bits = tabela->bits_raiz;
+
+    while(entrada->quantidade == 0){
+        if(entrada->bits == 0) return -1;
+
+        fluxo->acumulador <<= bits;
+        fluxo->quantidade -= bits;
+        completar_fluxo(fluxo);
+
+        bits = entrada->bits;
+        entrada = &tabela->entradas[entrada->subtabela + (fluxo->acumulador >> (64 - bits))];
+    }
+
+    fluxo->acumulador <<= entrada->bits_primeiro;
+    fluxo->quantidade -= entrada->bits_primeiro;
+    return entrada->simbolos[0];
+}
+
+/**
+ * @brief Faz uma consulta à tabela principal em um fluxo e grava um ou dois símbolos.
+ *
+ * O acumulador precisa ter pelo menos bits_raiz bits válidos e a saída, espaço para dois bytes.
+ *
+ * @param tabela Ponteiro para a tabela.
+ * @param fluxo Ponteiro para o leitor do fluxo.
+ * @param saida Ponteiro para a posição de saída do fluxo, que é avançada.
+ * @return int 1 em caso de sucesso ou 0 se o código for inválido.
+ */
+static inline int passo_fluxo(const TABELA_DECODIFICACAO *tabela, FLUXO_BITS *fluxo, unsigned char **saida){
+    const ENTRADA_TABELA *entrada = &tabela->entradas[fluxo->acumulador >> (64 - tabela->bits_raiz)];
+
+    if(entrada->quantidade == 0){
+        int simbolo = decodificar_simbolo_fluxo(tabela, fluxo);
+        if(simbolo < 0) return 0;
+        *(*saida)++ = simbolo;
+        completar_fluxo(fluxo);
+        return 1;
+    }
+
+    (*saida)[0] = entrada->simbolos[0];
+    (*saida)[1] = entrada->simbolos[1];
+    *saida += entrada->quantidade;
+    fluxo->acumulador <<= entrada->bits;
+    fluxo->quantidade -= entrada->bits;
+    return 1;
+}
+
+/**
+ * @brief Compacta um bloco em memória como quatro fluxos com os mesmos códigos canônicos.
+ *
+ * O tamanho de cada fluxo é calculado antes da codificação, pelos histogramas dos trechos, então
+ * os tamanhos são gravados antes dos fluxos sem voltar na saída.
+ *
+ * @param origem Bytes originais do bloco.
+ * @param tam_origem Quantidade de bytes originais.
+ * @param destino Região de saída.
+ * @param capacidade Tamanho da região de saída (limite_bloco_canonico mais 12 bytes sempre basta).
+ * @param max_bits Tamanho máximo dos códigos (0 sem limite).
+ * @return long Tamanho do bloco compactado ou -1 se a saída não couber.
+ */
+long compactar_quatro_fluxos(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade, int max_bits){
+    unsigned long frequencia[N_FLUXOS][TAM_ASCII] = {{0}}, total[TAM_ASCII] = {0};
+    size_t inicio[N_FLUXOS + 1];
+    unsigned char tamanhos[TAM_ASCII];
+    CODIGO codigos[TAM_ASCII];
+
+    for(int f = 0; f < N_FLUXOS; f++)
+        inicio[f] = f * (tam_origem / N_FLUXOS);
+    inicio[N_FLUXOS] = tam_origem;
+
+    for(int f = 0; f < N_FLUXOS; f++){
+        histograma(origem + inicio[f], inicio[f + 1] - inicio[f], frequencia[f]);
+        for(int s = 0; s < TAM_ASCII; s++)
+            total[s] += frequencia[f][s];
+    }
+
+    if(!escolher_tamanhos(total, max_bits, tamanhos))
+        return -1;
+    gerar_codigos_canonicos(tamanhos, codigos, TAM_ASCII);
+
+    ESCRITOR escritor;
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+    escrever_bytes(&escritor, (const unsigned char*)ASSINATURA, 2);
+    escrever_byte(&escritor, FORMATO_QUATRO_FLUXOS);
+    salvar_tabela_tamanhos(&escritor, tamanhos);
+
+    for(int f = 0; f < N_FLUXOS - 1; f++)
+        escrever_u32(&escritor, (contar_bits(frequencia[f], tamanhos, TAM_ASCII) + 7) / 8);
+
+    for(int f = 0; f < N_FLUXOS; f++){
+        ESCRITOR_BITS escritor_bits;
+        iniciar_escritor_bits(&escritor_bits, &escritor);
+        for(size_t i = inicio[f]; i < inicio[f + 1]; i++){
+            const CODIGO *codigo = &codigos[origem[i]];
+            escrever_bits(&escritor_bits, codigo->bits, codigo->tamanho);
+        }
+        finalizar_bits(&escritor_bits);
+    }
+
+    return escritor.erro ? -1 : (long)escritor.tamanho;
+}
+
+/**
+ * @brief Descompacta um bloco gravado por compactar_quatro_fluxos.
+ *
+ * O laço principal faz, a cada volta, duas consultas em cada um dos quatro fluxos; cada fluxo
+ * grava no seu trecho da saída. Perto do fim dos trechos, cada fluxo termina sozinho, um símbolo
+ * por vez.
+ *
+ * @param origem Bloco compactado.
+ * @param tam_compactado Tamanho do bloco compactado.
+ * @param destino Região de saída.
+ * @param tam_original Tamanho original do bloco.
+ * @return int 1 em caso de sucesso ou 0 se o bloco for inválido.
+ */
+int descompactar_quatro_fluxos(const unsigned char *origem, size_t tam_compactado, unsigned char *destino, size_t tam_original){
+    if(tam_compactado < 3 || memcmp(origem, ASSINATURA, 2) != 0 || origem[2] != FORMATO_QUATRO_FLUXOS)
+        return 0;
+
+    LEITOR leitor;
+    iniciar_leitor_memoria(&leitor, origem + 3, tam_compactado - 3);
+
+    unsigned char tamanhos[TAM_ASCII];
+    CODIGO codigos[TAM_ASCII];
+    long tam_tabela = ler_tabela_tamanhos(&leitor, tamanhos);
+    if(tam_tabela < 0 || (unsigned long)tam_tabela + 3 + 4 * (N_FLUXOS - 1) > tam_compactado)
+        return 0;
+
+    const unsigned char *dados = origem + 3 + tam_tabela + 4 * (N_FLUXOS - 1);
+    size_t restante = tam_compactado - 3 - tam_tabela - 4 * (N_FLUXOS - 1);
+    FLUXO_BITS fluxos[N_FLUXOS];
+    unsigned char *saida[N_FLUXOS], *limite[N_FLUXOS];
+
+    for(int f = 0; f < N_FLUXOS; f++){
+        unsigned long tam_fluxo = restante;
+        if(f < N_FLUXOS - 1){
+            ler_u32(&leitor, &tam_fluxo);
+            if(tam_fluxo > restante) return 0;
+        }
+        iniciar_fluxo(&fluxos[f], dados, tam_fluxo);
+        dados += tam_fluxo;
+        restante -= tam_fluxo;
+
+        saida[f] = destino + f * (tam_original / N_FLUXOS);
+        limite[f] = f < N_FLUXOS - 1 ? saida[f] + tam_original / N_FLUXOS : destino + tam_original;
+    }
+
+    gerar_codigos_canonicos(tamanhos, codigos, TAM_ASCII);
+
+    TABELA_DECODIFICACAO tabela;
+    if(!construir_tabela(&tabela, codigos, TAM_ASCII))
+        return tam_original == 0;
+
+    int ok = 1;
+    while(ok){
+        // Cada volta grava até 4 bytes por fluxo, então todos os trechos precisam ter esse espaço
+        int f;
+        for(f = 0; f < N_FLUXOS && limite[f] - saida[f] >= 4; f++);
+        if(f < N_FLUXOS) break;
+
+        for(f = 0; f < N_FLUXOS; f++)
+            completar_fluxo(&fluxos[f]);
+        for(f = 0; f < N_FLUXOS; f++)
+            ok &= passo_fluxo(&tabela, &fluxos[f], &saida[f]);
+        for(f = 0; f < N_FLUXOS; f++)
+            ok &= passo_fluxo(&tabela, &fluxos[f], &saida[f]);
+    }
+
+    for(int f = 0; f < N_FLUXOS && ok; f++){
+        while(saida[f] < limite[f]){
+            int simbolo = decodificar_simbolo_fluxo(&tabela, &fluxos[f]);
+            if(simbolo < 0){
+                ok = 0;
+                break;
+            }
+            *saida[f]++ = simbolo;
+        }
+
+        // Os zeros colocados depois do fim não podem ter sido consumidos
+        ok = ok && fluxos[f].extras * 8 <= fluxos[f].quantidade;
+    }
+
+    liberar_tabela(&tabela);
+    return ok;
+}
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * @file histograma.h
+ * @brief Contagem rápida da frequência dos bytes (histograma).
+ *
+ * Incrementar um único contador por byte cria uma dependência entre incrementos seguidos do mesmo
+ * byte (o próximo incremento espera o anterior ser gravado). O histograma usa 4 sub-histogramas
+ * intercalados, lê 8 bytes por vez e só soma os sub-histogramas no final. A versão que divide
+ * entradas muito grandes entre várias threads (histograma_paralelo) fica em paralelo.h.
+ */
+
+#ifndef HISTOGRAMA_H
+#define HISTOGRAMA_H
+
+#include "structs.h"
+
+/**
+ * @def LIMITE_SUBHISTOGRAMA
+ * @brief Bytes processados antes de somar os sub-histogramas, para os contadores de 32 bits não transbordarem.
+ */
+#define LIMITE_SUBHISTOGRAMA (1UL << 30)
+
+/**
+ * @brief Soma ao vetor de frequência a quantidade de cada byte dos dados.
+ *
+ * @param dados Bytes a serem contados.
+ * @param tamanho Quantidade de bytes.
+ * @param frequencia Vetor com 256 posições, que é acumulado (não é zerado).
+ */
+void histograma(const unsigned char *dados, size_t tamanho, unsigned long *frequencia){
+    unsigned int parcial[4][TAM_ASCII];
+
+    while(tamanho > 0){
+        size_t parte = tamanho < LIMITE_SUBHISTOGRAMA ? tamanho : LIMITE_SUBHISTOGRAMA;
+        size_t i = 0;
+
+        memset(parcial, 0, sizeof(parcial));
+
+        for(; i + 8 <= parte; i += 8){
+            unsigned long long v;
+            memcpy(&v, dados + i, 8);
+
+            parcial[0][v & 0xFF]++;
+            parcial[1][(v >> 8) & 0xFF]++;
+            parcial[2][(v >> 16) & 0xFF]++;
+            parcial[3][(v >> 24) & 0xFF]++;
+            parcial[0][(v >> 32) & 0xFF]++;
+            parcial[1][(v >> 40) & 0xFF]++;
+            parcial[2][(v >> 48) & 0xFF]++;
+            parcial[3][v >> 56]++;
+        }
+        for(; i < parte; i++)
+            parcial[0][dados[i]]++;
+
+        for(int s = 0; s < TAM_ASCII; s++)
+            frequencia[s] += (unsigned long)parcial[0][s] + parcial[1][s] + parcial[2][s] + parcial[3][s];
+
+        dados += parte;
+        tamanho -= parte;
+    }
+}
+
+#endif
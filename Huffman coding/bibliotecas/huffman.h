@@ -3,7 +3,12 @@
  * @brief Funções para a compactação e descompactação Huffman.
  */
 
-#include "structs.h"
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include "tabela_decodificacao.h"
+#include "paralelo.h"
+#include "mapeamento.h"
 
 /**
  * @brief Retorna o tamanho em bytes de um arquivo.
@@ -22,113 +27,169 @@ unsigned long tamanho_arquivo(FILE *arquivo_entrada){
 }
 
 /**
- * @brief Conta a frequência de cada byte no arquivo.
+ * @brief Conta a frequência de cada byte do arquivo e volta o leitor para o início.
+ *
+ * Com o arquivo mapeado, o leitor entrega todos os bytes de uma vez, e entradas grandes são
+ * contadas em paralelo.
  * 
- * @param arquivo_entrada Ponteiro para o arquivo.
+ * @param leitor Leitor do arquivo original, posicionado no início.
  * @param tam_arq Tamanho do arquivo.
- * @return unsigned long* Vetor de frequência com 256 posições.
+ * @return unsigned long* Vetor de frequência com 256 posições ou NULL se faltar memória.
  */
-unsigned long *contar_frequencia(FILE *arquivo_entrada, unsigned long tam_arq){
+unsigned long *contar_frequencia(LEITOR *leitor, unsigned long tam_arq){
     unsigned long *frequencia = calloc(TAM_ASCII, sizeof(unsigned long));
-    unsigned char byte;
+    if(!frequencia) return NULL;
 
-    for(int i = 0; i < tam_arq; i++){
-        fread(&byte, sizeof(unsigned char), 1, arquivo_entrada);
-        frequencia[byte]++; 
+    unsigned long restante = tam_arq;
+    while(restante > 0 && recarregar_leitor(leitor) > 0){
+        size_t n = leitor->tamanho < restante ? leitor->tamanho : restante;
+        histograma_paralelo(leitor->dados, n, frequencia, 0);
+        restante -= n;
     }
 
-    rewind(arquivo_entrada);
+    reiniciar_leitor(leitor);
     return frequencia;
 }
 
 /**
- * @brief Adiciona o nó de forma ordenada.
+ * @brief Inicializa uma heap mínima vazia.
  * 
- * @param fila Ponteiro para a fila.
- * @param novo Ponteiro para o no a ser ordenado.
+ * @param heap Ponteiro para a heap.
+ * @param capacidade Quantidade máxima de nós.
+ * @return int 1 em caso de sucesso ou 0 se faltar memória.
  */
-void inserir_ordenado(LISTA *fila, NOHUFF *novo){
-    if(fila->inicio == NULL || novo->frequencia <= fila->inicio->frequencia){
-        novo->prox = fila->inicio;
-        fila->inicio = novo;
-    }else{
-        NOHUFF *aux = fila->inicio;
-        while(aux->prox && aux->prox->frequencia < novo->frequencia)
-            aux = aux->prox;
-        novo->prox = aux->prox;
-        aux->prox = novo;
+int iniciar_heap(HEAP *heap, int capacidade){
+    heap->dados = malloc(sizeof(NOHUFF*) * (capacidade > 0 ? capacidade : 1));
+    heap->tamanho = 0;
+    heap->capacidade = capacidade;
+    return heap->dados != NULL;
+}
+
+/**
+ * @brief Adiciona um nó na heap, subindo-o até a posição correta.
+ * 
+ * @param heap Ponteiro para a heap.
+ * @param novo Ponteiro para o no a ser inserido.
+ */
+void inserir_heap(HEAP *heap, NOHUFF *novo){
+    int i = heap->tamanho++;
+
+    while(i > 0){
+        int pai = (i - 1) / 2;
+        if(heap->dados[pai]->frequencia <= novo->frequencia)
+            break;
+        heap->dados[i] = heap->dados[pai];
+        i = pai;
     }
-    fila->tamanho++;
+    heap->dados[i] = novo;
 }
 
 /**
- * @brief Cria um novo no para a lista encadeada ordenada.
+ * @brief Remove o nó de menor frequencia, que se encontra na raiz da heap.
  * 
- * @param frequencia Array com as frequencias.
- * @param lista Ponteiro para a lista encadeada ordenada.
+ * @param heap Ponteiro para a heap.
+ * @return O no removido ou NULL se a heap estiver vazia.
  */
-void preencher_fila(unsigned long *frequencia, LISTA *lista){
-    NOHUFF *novo;
-    for(int i = 0; i < TAM_ASCII; i++){
-        if(frequencia[i] > 0){
-            novo = malloc(sizeof(NOHUFF));
+NOHUFF *remove_minimo(HEAP *heap){
+    if(heap->tamanho == 0) return NULL;
+
+    NOHUFF *minimo = heap->dados[0];
+    NOHUFF *ultimo = heap->dados[--heap->tamanho];
+    int i = 0;
+
+    while(2 * i + 1 < heap->tamanho){
+        int filho = 2 * i + 1;
+        if(filho + 1 < heap->tamanho && heap->dados[filho + 1]->frequencia < heap->dados[filho]->frequencia)
+            filho++;
+        if(ultimo->frequencia <= heap->dados[filho]->frequencia)
+            break;
+        heap->dados[i] = heap->dados[filho];
+        i = filho;
+    }
+    if(heap->tamanho > 0)
+        heap->dados[i] = ultimo;
 
-            novo->caracter = malloc(sizeof(unsigned char));
-            *(unsigned char*) novo->caracter = i;
-            novo->frequencia = frequencia[i];
-            novo->direita = NULL;
-            novo->esquerda = NULL;
-            novo->prox = NULL;
+    return minimo;
+}
 
-            inserir_ordenado(lista, novo);
-        }
-    }
+/**
+ * @brief Prepara uma arena vazia (ou descarta de uma vez todos os nós de uma arena já usada).
+ * 
+ * @param arena Ponteiro para a arena.
+ */
+void iniciar_arena(ARENA_NOS *arena){
+    arena->tamanho = 0;
 }
 
 /**
- * @brief Remove o caracter com menor frequencia, da lista, que se encontra no inicio, pois ela está ordenada do menor para o maior
+ * @brief Funcao usada para criar um novo no para arvore, tirando-o da arena.
  * 
- * @param fila Ponteiro para o início da fila.
- * @return O no removido.
+ * @param arena Arena de onde o nó é tirado.
+ * @param caractere Caracter a ser adicionado na arvore.
+ * @param frequencia Frequência do nó.
+ * @param esquerda Ponteiro para o no esquerdo.
+ * @param direita Ponteiro para o no direito.
+ * @return ponteiro para NOHUFF do novo no ou NULL se a arena estiver cheia.
  */
-NOHUFF *remove_no_inicio(LISTA *fila){
-    NOHUFF *aux = NULL;
-
-    if (fila->inicio){
-        aux = fila->inicio;
-        fila->inicio = aux->prox;
-        aux->prox = NULL;
-        fila->tamanho--;
-    }
+NOHUFF* criar_arvore(ARENA_NOS *arena, unsigned char caractere, unsigned long frequencia, NOHUFF *esquerda, NOHUFF *direita){
+    if(arena->tamanho == MAX_NOS_ARVORE)
+        return NULL;
+
+    NOHUFF *novo = &arena->nos[arena->tamanho++];
+    novo->caracter = caractere;
+    novo->frequencia = frequencia;
+    novo->esquerda = esquerda;
+    novo->direita = direita;
+
+    return novo;
+}
 
-    return aux;
+/**
+ * @brief Cria um novo no para cada caractere presente e o coloca na heap.
+ * 
+ * @param frequencia Array com as frequencias.
+ * @param heap Ponteiro para a heap (capacidade de pelo menos TAM_ASCII nós).
+ * @param arena Arena de onde os nós são tirados.
+ */
+void preencher_heap(unsigned long *frequencia, HEAP *heap, ARENA_NOS *arena){
+    for(int i = 0; i < TAM_ASCII; i++){
+        if(frequencia[i] > 0)
+            inserir_heap(heap, criar_arvore(arena, i, frequencia[i], NULL, NULL));
+    }
 }
 
 /**
- * @brief Monta a arvore de huffman, juntando os dois ultimos nos.
+ * @brief Monta a arvore de huffman, juntando os dois nos de menor frequencia até restar um.
+ * 
+ * Cada junção custa O(log n) na heap, em vez da inserção linear da lista ordenada.
  * 
- * @param fila Ponteiro para a fila.
+ * @param heap Ponteiro para a heap.
+ * @param arena Arena de onde os nós internos são tirados (a mesma das folhas).
  * @return retorna a raiz da arvore.
  */
-NOHUFF *montar_arvore(LISTA *fila){
-    NOHUFF *primeiro, *segundo, *novo;
-    while(fila->tamanho > 1){
-        primeiro = remove_no_inicio(fila);
-        segundo = remove_no_inicio(fila);
-
-        novo = malloc(sizeof(NOHUFF));
-        novo->caracter = malloc(sizeof(unsigned char));
-        *(unsigned char*)novo->caracter = '*';
-        novo->frequencia = primeiro->frequencia + segundo->frequencia;
-        novo->esquerda = primeiro;
-        novo->direita = segundo;
-        novo->prox = NULL;
-
-        inserir_ordenado(fila, novo);
+NOHUFF *montar_arvore(HEAP *heap, ARENA_NOS *arena){
+    NOHUFF *primeiro, *segundo;
+    while(heap->tamanho > 1){
+        primeiro = remove_minimo(heap);
+        segundo = remove_minimo(heap);
+
+        inserir_heap(heap, criar_arvore(arena, '*', primeiro->frequencia + segundo->frequencia, primeiro, segundo));
     }
 
-    return fila->inicio;
+    return remove_minimo(heap);
+}
+
+/**
+ * @brief Libera o vetor da heap.
+ * 
+ * @param heap Ponteiro para a heap.
+ */
+void liberar_heap(HEAP *heap){
+    free(heap->dados);
+    heap->dados = NULL;
+    heap->tamanho = heap->capacidade = 0;
 }
+
 /**
  * @brief Calcula a altura da árvore de Huffman.
  * 
@@ -145,28 +206,26 @@ unsigned int altura_arvore(NOHUFF *raiz){
 }
 
 /**
- * @brief Gera o dicionário de códigos binários para cada caractere.
+ * @brief Gera os códigos de cada caractere como inteiros (bits e tamanho), percorrendo a árvore.
+ * 
+ * Uma árvore com um único nó recebe o código "0" de tamanho 1.
  * 
- * @param dicionario Vetor de strings com os códigos.
+ * @param codigos Vetor com 256 códigos, indexado pelo caractere.
  * @param raiz Ponteiro para a árvore.
- * @param caminho Caminho atual (string de 0s e 1s).
- * @param tam_max Tamanho máximo das strings do caminho.
+ * @param bits Bits do caminho atual.
+ * @param tamanho Tamanho do caminho atual.
  */
-void gerar_dicionario(unsigned char **dicionario, NOHUFF *raiz, char *caminho, unsigned int tam_max){
-    char esquerda[tam_max], direita[tam_max];
+void gerar_codigos(CODIGO *codigos, NOHUFF *raiz, unsigned long long bits, unsigned char tamanho){
+    if(!raiz) return;
 
-    if(!raiz->esquerda && !raiz->direita)
-        strcpy(dicionario[*(unsigned char*)raiz->caracter], caminho);
-    else{
-        strcpy(esquerda, caminho);
-        strcpy(direita, caminho);
-
-        strcat(esquerda, "0");
-        strcat(direita, "1");
-
-        gerar_dicionario(dicionario, raiz->esquerda, esquerda, tam_max);
-        gerar_dicionario(dicionario, raiz->direita, direita, tam_max);
+    if(!raiz->esquerda && !raiz->direita){
+        codigos[raiz->caracter].bits = bits;
+        codigos[raiz->caracter].tamanho = tamanho ? tamanho : 1;
+        return;
     }
+
+    gerar_codigos(codigos, raiz->esquerda, bits << 1, tamanho + 1);
+    gerar_codigos(codigos, raiz->direita, (bits << 1) | 1, tamanho + 1);
 }
 
 /**
@@ -179,12 +238,12 @@ void gerar_dicionario(unsigned char **dicionario, NOHUFF *raiz, char *caminho, u
 short salvar_arvore(NOHUFF *raiz, FILE *arquivo_saida){
     if(!raiz) return 0;
     
-    int folha_escape = (*(unsigned char*)raiz->caracter == '*' || *(unsigned char*)raiz->caracter == '\\') && !raiz->esquerda && !raiz->direita;
+    int folha_escape = (raiz->caracter == '*' || raiz->caracter == '\\') && !raiz->esquerda && !raiz->direita;
 
     if(folha_escape)
         fwrite("\\", sizeof(unsigned char), 1, arquivo_saida);
     
-    fwrite(&*(unsigned char*)raiz->caracter, sizeof(unsigned char), 1, arquivo_saida);
+    fwrite(&raiz->caracter, sizeof(unsigned char), 1, arquivo_saida);
     int esquerda = salvar_arvore(raiz->esquerda, arquivo_saida);
     int direita = salvar_arvore(raiz->direita, arquivo_saida);
     
@@ -192,49 +251,41 @@ short salvar_arvore(NOHUFF *raiz, FILE *arquivo_saida){
 }
 
 /**
- * @brief Salva os dados comprimidos no arquivo.
+ * @brief Salva os dados comprimidos no arquivo, lendo e escrevendo em blocos.
  * 
- * @param arquivo_entrada Ponteiro para o arquivo original.
+ * Cada caractere custa uma única escrita de bits no acumulador de 64 bits, que é gravado
+ * como uma palavra inteira sempre que enche.
+ * 
+ * @param leitor Leitor do arquivo original, posicionado no início.
  * @param arquivo_saida Ponteiro para o arquivo de saída.
- * @param dicionario Vetor de dicionário de Huffman.
+ * @param codigos Vetor com o código de cada caractere.
  * @param tam_arq Tamanho do arquivo original.
- * @param tam_arvore Tamanho da arvore binaria.
- * @return short tamanho do lixo obtido no ultimo byte.
+ * @param tam_bloco Tamanho dos blocos de escrita (0 usa TAM_BLOCO_IO).
+ * @return short tamanho do lixo obtido no ultimo byte ou -1 se faltar memória.
  */
-short salvar_dados(FILE *arquivo_entrada, FILE *arquivo_saida, unsigned char **dicionario, int tam_arquivo, int tam_arvore){
-    int bit_atual = 0;
-    int tamanho_lixo = 0;
-    unsigned char escrever_buffer = 0;
-    unsigned char ler_buffer;
+short salvar_dados(LEITOR *leitor, FILE *arquivo_saida, const CODIGO *codigos, unsigned long tam_arquivo, size_t tam_bloco){
+    ESCRITOR escritor;
+    ESCRITOR_BITS escritor_bits;
 
     fseek(arquivo_saida, 0, SEEK_END);
 
-    for (int i = 0; i < tam_arquivo; i++){
-        fread(&ler_buffer, sizeof(unsigned char), 1, arquivo_entrada);
-        unsigned char *codigo = dicionario[ler_buffer];
-
-        for(int j = 0; codigo[j] != '\0'; j++){
-            escrever_buffer <<= 1;
-            if(codigo[j] == '1')
-                escrever_buffer |= 1;
-            
-            bit_atual++;
-
-            if(bit_atual == 8){
-                fwrite(&escrever_buffer, sizeof(unsigned char), 1, arquivo_saida);
-                escrever_buffer = 0;
-                bit_atual = 0;
-            }
+    if(!iniciar_escritor(&escritor, arquivo_saida, tam_bloco))
+        return -1;
+    iniciar_escritor_bits(&escritor_bits, &escritor);
+
+    unsigned long restante = tam_arquivo;
+    while(restante > 0 && recarregar_leitor(leitor) > 0){
+        size_t n = leitor->tamanho < restante ? leitor->tamanho : restante;
+        for(size_t i = 0; i < n; i++){
+            const CODIGO *codigo = &codigos[leitor->dados[i]];
+            escrever_bits(&escritor_bits, codigo->bits, codigo->tamanho);
         }
+        restante -= n;
     }
 
-    if(bit_atual > 0){
-        escrever_buffer <<= 8 - bit_atual;
-        fwrite(&escrever_buffer, sizeof(unsigned char), 1, arquivo_saida);
-        tamanho_lixo = 8 - bit_atual;
-    }
+    short tamanho_lixo = finalizar_bits(&escritor_bits);
 
-    fclose(arquivo_entrada);
+    liberar_escritor(&escritor);
     rewind(arquivo_saida);
     return tamanho_lixo;
 }
@@ -259,55 +310,36 @@ void salvar_cabecalho(FILE *arquivo_saida, unsigned short tam_lixo, unsigned sho
 /**
  * @brief Le o cabecalho do arquivo compactado para descobrir o tamanho do lixo e arvore.
  * 
- * @param arquivo_entrada Nome do arquivo de entrada.
+ * @param leitor Leitor do arquivo compactado, posicionado no início.
  * @param tam_lixo Ponteiro para guardar o tamanho do lixo no final do arquivo.
  * @param tam_arvore Ponteiro para guardar o tamanho da arvore binaria.
  */
-void ler_cabecalho(FILE *arquivo_entrada, unsigned short *tam_lixo, unsigned short *tam_arvore){
-    unsigned char buffer;
-    fread(&buffer, sizeof(char), 1, arquivo_entrada);
+void ler_cabecalho(LEITOR *leitor, unsigned short *tam_lixo, unsigned short *tam_arvore){
+    unsigned char buffer = 0;
+    ler_byte(leitor, &buffer);
 
     unsigned short cabecalho = buffer << 8;
 
-    fread(&buffer, sizeof(char), 1, arquivo_entrada);
+    buffer = 0;
+    ler_byte(leitor, &buffer);
 
     cabecalho |= buffer;
 
     *tam_lixo = cabecalho >> 13;
     *tam_arvore = cabecalho & 0x1FFF;
-
-    printf("\n\tTamanho Lixo: %d\n", *tam_lixo);
-    printf("\n\tTamanho Arvore: %d\n", *tam_arvore);
-}
-
-/**
- * @brief Funcao usada para criar um novo no para arvore.
- * 
- * @param caractere Caracter a ser adicionado na arvore.
- * @param esquerda Ponteiro para o no esquerdo.
- * @param direita Ponteiro para o no direito.
- * @return ponteiro para NOHUFF do novo no.
- */
-NOHUFF* criar_arvore(unsigned char caractere, NOHUFF *esquerda, NOHUFF *direita){
-    NOHUFF *novo = malloc(sizeof(NOHUFF));
-    novo->caracter = malloc(sizeof(unsigned char));
-    *(unsigned char*) novo->caracter = caractere;
-    novo->esquerda = esquerda;
-    novo->direita = direita;
-
-    return novo;
 }
 
 /**
  * @brief Funcao usada para remontar arvore.
  * 
- * @param arquivo_entrada Nome do arquivo entrada.
+ * @param leitor Leitor posicionado no início da arvore.
  * @param tam_arvore Tamanho da arvore.
- * @return ponteiro NOHUFF de forma recursiva retorna a raiz da arvore.
+ * @param arena Arena de onde os nós são tirados.
+ * @return ponteiro NOHUFF de forma recursiva retorna a raiz da arvore ou NULL se ela for inválida.
  */
-NOHUFF *remontar_arvore(FILE *arquivo_entrada, unsigned short *tam_arvore){
-    unsigned char buffer;
-    fread(&buffer, sizeof(unsigned char), 1, arquivo_entrada);
+NOHUFF *remontar_arvore(LEITOR *leitor, unsigned short *tam_arvore, ARENA_NOS *arena){
+    unsigned char buffer = 0;
+    ler_byte(leitor, &buffer);
 
     int e_folha = 0;
     if(*tam_arvore == 0)
@@ -315,7 +347,7 @@ NOHUFF *remontar_arvore(FILE *arquivo_entrada, unsigned short *tam_arvore){
     (*tam_arvore)--;
     if(buffer == '\\'){
         (*tam_arvore)--;
-        fread(&buffer, sizeof(unsigned char), 1, arquivo_entrada);
+        ler_byte(leitor, &buffer);
         e_folha = 1;
     }
     if(buffer != '*'){
@@ -323,35 +355,34 @@ NOHUFF *remontar_arvore(FILE *arquivo_entrada, unsigned short *tam_arvore){
     }
 
     if(e_folha){
-        return criar_arvore(buffer, NULL, NULL);
+        return criar_arvore(arena, buffer, 0, NULL, NULL);
     }
-    NOHUFF *esquerda = remontar_arvore(arquivo_entrada, tam_arvore);
-    NOHUFF *direita = remontar_arvore(arquivo_entrada, tam_arvore);
-    return criar_arvore('*', esquerda, direita);
+    NOHUFF *esquerda = remontar_arvore(leitor, tam_arvore, arena);
+    NOHUFF *direita = remontar_arvore(leitor, tam_arvore, arena);
+    if(!esquerda || !direita)
+        return NULL;
+    return criar_arvore(arena, '*', 0, esquerda, direita);
 }
 
 /**
- * @brief Funcao principal para decodificar o arquivo.
+ * @brief Decodifica o arquivo andando na árvore bit a bit.
  * 
- * @param arquivo_entrada Nome do arquivo entrada.
- * @param arquivo_saida Nome do arquivo saida.
- * @param tam_arquivo Tamanho do arquivo compactado.
- * @param tam_lixo Tamanho do lixo no ultimo byte do arquivo.
- * @param tam_arvore Tamanho da arvore.
+ * Usada apenas quando a árvore tem códigos maiores que MAX_BITS_CODIGO, que não cabem na tabela.
+ * 
+ * @param raiz Raiz da árvore remontada.
+ * @param leitor Leitor posicionado no início dos dados.
+ * @param escritor Escritor de saída.
+ * @param total_bits Quantidade de bits válidos nos dados.
  */
-void decodificar(FILE *arquivo_entrada, FILE *arquivo_saida, unsigned long tam_arquivo, unsigned short tam_lixo, unsigned short tam_arvore){
-    tam_arquivo -= tam_arvore + 2;
-    tam_arquivo <<= 3;
-    tam_arquivo -= tam_lixo;
-
-    NOHUFF *raiz = remontar_arvore(arquivo_entrada, &tam_arvore);
+void decodificar_por_arvore(NOHUFF *raiz, LEITOR *leitor, ESCRITOR *escritor, unsigned long long total_bits){
     NOHUFF *aux = raiz;
     unsigned char buffer;
     int bit_atual = 0;
 
-    while(tam_arquivo--){
+    while(total_bits--){
         if(bit_atual == 0){
-            fread(&buffer, sizeof(unsigned char), 1, arquivo_entrada);
+            if(!ler_byte(leitor, &buffer))
+                break;
             bit_atual = 8;
         }
 
@@ -362,35 +393,70 @@ void decodificar(FILE *arquivo_entrada, FILE *arquivo_saida, unsigned long tam_a
         }
 
         if(aux->esquerda == NULL && aux->direita == NULL){
-            fwrite(&*(unsigned char*)aux->caracter, sizeof(unsigned char), 1, arquivo_saida);
+            escrever_byte(escritor, aux->caracter);
             aux = raiz;
         }
     }
 }
 
 /**
- * @brief Libera toda a memória alocada para a árvore de Huffman
+ * @brief Funcao principal para decodificar o arquivo.
  * 
- * @param raiz Ponteiro para a raiz da árvore
- */
-void liberar_arvore(NOHUFF* raiz) {
-    if (raiz == NULL) return;
-    liberar_arvore(raiz->esquerda);
-    liberar_arvore(raiz->direita);
-    free(raiz);
-}
-
-/**
- * @brief Libera toda a memória alocada para o dicionário
+ * A árvore é remontada e convertida em uma tabela de decodificação, que resolve até BITS_TABELA
+ * bits (um ou dois caracteres) por consulta em vez de seguir um ponteiro por bit.
  * 
- * @param dicionario Ponteiro para o dicionário
+ * @param leitor Leitor do arquivo compactado, posicionado logo depois do cabeçalho.
+ * @param arquivo_saida Nome do arquivo saida.
+ * @param tam_arquivo Tamanho do arquivo compactado.
+ * @param tam_lixo Tamanho do lixo no ultimo byte do arquivo.
+ * @param tam_arvore Tamanho da arvore.
+ * @param tam_bloco Tamanho dos blocos de escrita (0 usa TAM_BLOCO_IO).
+ * @return int 1 em caso de sucesso ou 0 se o arquivo for inválido.
  */
-void liberar_dicionario(unsigned char **dicionario) {
-    if (!dicionario) return;
-    
-    for (int i = 0; i < TAM_ASCII; i++) {
-        if (dicionario[i]) free(dicionario[i]);
+int decodificar(LEITOR *leitor, FILE *arquivo_saida, unsigned long tam_arquivo, unsigned short tam_lixo, unsigned short tam_arvore, size_t tam_bloco){
+    // O cabeçalho não pode prometer mais bytes do que o arquivo tem, nem lixo sem nenhum byte de dados
+    if((unsigned long)tam_arvore + 2 > tam_arquivo)
+        return 0;
+    if(tam_arquivo == (unsigned long)tam_arvore + 2 && tam_lixo > 0)
+        return 0;
+
+    tam_arquivo -= tam_arvore + 2;
+    tam_arquivo <<= 3;
+    tam_arquivo -= tam_lixo;
+
+    ARENA_NOS arena;
+    iniciar_arena(&arena);
+
+    NOHUFF *raiz = remontar_arvore(leitor, &tam_arvore, &arena);
+    ESCRITOR escritor;
+
+    if(!raiz)
+        return 0;
+    if(!iniciar_escritor(&escritor, arquivo_saida, tam_bloco))
+        return 0;
+
+    CODIGO codigos[TAM_ASCII] = {0};
+    TABELA_DECODIFICACAO tabela;
+
+    int usar_tabela = altura_arvore(raiz) <= MAX_BITS_CODIGO;
+
+    if(usar_tabela){
+        gerar_codigos(codigos, raiz, 0, 0);
+        usar_tabela = construir_tabela(&tabela, codigos, TAM_ASCII);
     }
-    
-    free(dicionario);
+
+    int ok = 1;
+    if(usar_tabela){
+        LEITOR_BITS leitor_bits;
+        iniciar_leitor_bits(&leitor_bits, leitor);
+        ok = decodificar_com_tabela(&tabela, &leitor_bits, tam_arquivo, &escritor);
+        liberar_tabela(&tabela);
+    }else{
+        decodificar_por_arvore(raiz, leitor, &escritor, tam_arquivo);
+    }
+
+    liberar_escritor(&escritor);
+    return ok;
 }
+
+#endif
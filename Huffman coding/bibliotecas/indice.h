@@ -0,0 +1,328 @@
+/**
+ * @file indice.h
+ * @brief Rodapé opcional do formato em blocos: índice de posições e somas de verificação.
+ *
+ * Quando o byte de tamanho máximo dos códigos do cabeçalho tem o bit COM_INDICE ligado, o arquivo
+ * em blocos continua, depois dos 4 bytes zerados do fim, com um rodapé:
+ * - para cada bloco, 8 bytes com a posição do índice do bloco (contada do início do arquivo) e
+ *   4 bytes com a soma de verificação dos bytes originais do bloco;
+ * - 8 bytes com o tamanho total dos dados originais;
+ * - 4 bytes com a quantidade de blocos;
+ * - 4 bytes com a assinatura ASSINATURA_INDICE.
+ *
+ * O rodapé fica no fim para que seja achado a partir do tamanho do arquivo: um trecho dos dados
+ * originais é descompactado lendo só o rodapé e os blocos que o cobrem. Quem não conhece o rodapé
+ * para de ler no fim dos blocos, então os arquivos com índice continuam legíveis pelos leitores antigos.
+ */
+
+#ifndef INDICE_H
+#define INDICE_H
+
+#include "memoria.h"
+
+// Posições de 64 bits: no POSIX, structs.h define _FILE_OFFSET_BITS para o off_t de fseeko/ftello
+#ifdef _WIN32
+#define posicionar_arquivo _fseeki64
+#define posicao_arquivo _ftelli64
+#else
+#define posicionar_arquivo fseeko
+#define posicao_arquivo ftello
+#endif
+
+/**
+ * @def COM_INDICE
+ * @brief Bit do byte de tamanho máximo dos códigos que indica que o arquivo tem o rodapé.
+ */
+#define COM_INDICE 0x80
+
+/**
+ * @def ASSINATURA_INDICE
+ * @brief Assinatura gravada nos últimos 4 bytes do rodapé.
+ */
+#define ASSINATURA_INDICE "HFIX"
+
+/**
+ * @def TAM_ENTRADA_INDICE
+ * @brief Bytes de cada bloco no rodapé (posição e soma de verificação).
+ */
+#define TAM_ENTRADA_INDICE 12
+
+/**
+ * @def TAM_FIM_INDICE
+ * @brief Bytes do final do rodapé (tamanho total, quantidade de blocos e assinatura).
+ */
+#define TAM_FIM_INDICE 16
+
+/**
+ * @struct INDICE
+ * @brief Posições e somas de verificação dos blocos, acumuladas durante a compactação ou a descompactação.
+ *
+ * - posicoes: posição do índice de cada bloco, contada do início do arquivo.
+ * - somas: soma de verificação dos bytes originais de cada bloco.
+ * - quantidade: quantidade de blocos.
+ * - capacidade: espaço alocado nos vetores.
+ */
+typedef struct{
+    unsigned long long *posicoes;
+    unsigned long *somas;
+    long quantidade;
+    long capacidade;
+}INDICE;
+
+/**
+ * @brief Lê 4 bytes como um inteiro little-endian, independente da máquina.
+ *
+ * @param origem Vetor com pelo menos 4 bytes.
+ * @return unsigned long Valor lido.
+ */
+static inline unsigned long ler_le32(const unsigned char *origem){
+    return (unsigned long)origem[0] | ((unsigned long)origem[1] << 8) | ((unsigned long)origem[2] << 16) | ((unsigned long)origem[3] << 24);
+}
+
+/**
+ * @brief Rotaciona um inteiro de 32 bits para a esquerda.
+ */
+static inline unsigned long rotacionar32(unsigned long valor, int bits){
+    return ((valor << bits) | (valor >> (32 - bits))) & 0xFFFFFFFFUL;
+}
+
+/**
+ * @brief Calcula a soma de verificação de um bloco (o XXH32 com semente 0).
+ *
+ * Quatro acumuladores independentes consomem 16 bytes por volta, então a soma custa bem menos
+ * que a decodificação do bloco.
+ *
+ * @param dados Bytes do bloco.
+ * @param tamanho Quantidade de bytes.
+ * @return unsigned long Soma de 32 bits.
+ */
+unsigned long soma_verificacao(const unsigned char *dados, size_t tamanho){
+    const unsigned long P1 = 2654435761UL, P2 = 2246822519UL, P3 = 3266489917UL, P4 = 668265263UL, P5 = 374761393UL;
+    const unsigned char *fim = dados + tamanho;
+    unsigned long soma;
+
+    if(tamanho >= 16){
+        unsigned long v[4] = {(P1 + P2) & 0xFFFFFFFFUL, P2, 0, (0 - P1) & 0xFFFFFFFFUL};
+        for(; fim - dados >= 16; dados += 16){
+            for(int i = 0; i < 4; i++){
+                v[i] = (v[i] + ler_le32(dados + 4 * i) * P2) & 0xFFFFFFFFUL;
+                v[i] = (rotacionar32(v[i], 13) * P1) & 0xFFFFFFFFUL;
+            }
+        }
+        soma = rotacionar32(v[0], 1) + rotacionar32(v[1], 7) + rotacionar32(v[2], 12) + rotacionar32(v[3], 18);
+    }else{
+        soma = P5;
+    }
+    soma = (soma + tamanho) & 0xFFFFFFFFUL;
+
+    for(; fim - dados >= 4; dados += 4){
+        soma = (soma + ler_le32(dados) * P3) & 0xFFFFFFFFUL;
+        soma = (rotacionar32(soma, 17) * P4) & 0xFFFFFFFFUL;
+    }
+    for(; dados < fim; dados++){
+        soma = (soma + *dados * P5) & 0xFFFFFFFFUL;
+        soma = (rotacionar32(soma, 11) * P1) & 0xFFFFFFFFUL;
+    }
+
+    soma ^= soma >> 15;
+    soma = (soma * P2) & 0xFFFFFFFFUL;
+    soma ^= soma >> 13;
+    soma = (soma * P3) & 0xFFFFFFFFUL;
+    soma ^= soma >> 16;
+    return soma;
+}
+
+/**
+ * @brief Inicia um índice vazio.
+ *
+ * @param indice Ponteiro para o índice.
+ */
+void iniciar_indice(INDICE *indice){
+    indice->posicoes = NULL;
+    indice->somas = NULL;
+    indice->quantidade = 0;
+    indice->capacidade = 0;
+}
+
+/**
+ * @brief Libera os vetores do índice.
+ *
+ * @param indice Ponteiro para o índice.
+ */
+void liberar_indice(INDICE *indice){
+    free(indice->posicoes);
+    free(indice->somas);
+    iniciar_indice(indice);
+}
+
+/**
+ * @brief Acrescenta um bloco ao índice.
+ *
+ * @param indice Ponteiro para o índice.
+ * @param posicao Posição do índice do bloco no arquivo.
+ * @param soma Soma de verificação dos bytes originais do bloco.
+ * @return int 1 em caso de sucesso ou 0 se faltar memória.
+ */
+int adicionar_bloco_indice(INDICE *indice, unsigned long long posicao, unsigned long soma){
+    if(indice->quantidade == indice->capacidade){
+        long capacidade = indice->capacidade ? 2 * indice->capacidade : 64;
+        unsigned long long *posicoes = realloc(indice->posicoes, capacidade * sizeof(unsigned long long));
+        if(!posicoes) return 0;
+        indice->posicoes = posicoes;
+
+        unsigned long *somas = realloc(indice->somas, capacidade * sizeof(unsigned long));
+        if(!somas) return 0;
+        indice->somas = somas;
+        indice->capacidade = capacidade;
+    }
+
+    indice->posicoes[indice->quantidade] = posicao;
+    indice->somas[indice->quantidade] = soma;
+    indice->quantidade++;
+    return 1;
+}
+
+/**
+ * @brief Grava o rodapé com o índice dos blocos.
+ *
+ * @param indice Ponteiro para o índice.
+ * @param tam_total Tamanho total dos dados originais.
+ * @param arquivo_saida Arquivo de saída, logo depois do fim dos blocos.
+ * @return int 1 em caso de sucesso ou 0 em caso de erro de escrita.
+ */
+int gravar_indice(const INDICE *indice, unsigned long long tam_total, FILE *arquivo_saida){
+    unsigned char entrada[TAM_FIM_INDICE];
+
+    for(long i = 0; i < indice->quantidade; i++){
+        gravar_u64(entrada, indice->posicoes[i]);
+        gravar_u32(entrada + 8, indice->somas[i]);
+        if(fwrite(entrada, 1, TAM_ENTRADA_INDICE, arquivo_saida) != TAM_ENTRADA_INDICE)
+            return 0;
+    }
+
+    gravar_u64(entrada, tam_total);
+    gravar_u32(entrada + 8, indice->quantidade);
+    memcpy(entrada + 12, ASSINATURA_INDICE, 4);
+    return fwrite(entrada, 1, TAM_FIM_INDICE, arquivo_saida) == TAM_FIM_INDICE;
+}
+
+/**
+ * @brief Lê o rodapé e confere se ele descreve os blocos que foram descompactados.
+ *
+ * @param indice Índice montado durante a descompactação.
+ * @param tam_total Tamanho total dos dados descompactados.
+ * @param leitor Leitor posicionado logo depois do fim dos blocos.
+ * @return int 1 se o rodapé conferir ou 0 se ele for inválido ou alguma soma não bater.
+ */
+int conferir_indice(const INDICE *indice, unsigned long long tam_total, LEITOR *leitor){
+    unsigned char entrada[TAM_FIM_INDICE];
+
+    for(long i = 0; i < indice->quantidade; i++){
+        if(ler_bytes(leitor, entrada, TAM_ENTRADA_INDICE) != TAM_ENTRADA_INDICE ||
+           extrair_u64(entrada) != indice->posicoes[i] || extrair_u32(entrada + 8) != indice->somas[i])
+            return 0;
+    }
+
+    return ler_bytes(leitor, entrada, TAM_FIM_INDICE) == TAM_FIM_INDICE &&
+           extrair_u64(entrada) == tam_total &&
+           extrair_u32(entrada + 8) == (unsigned long)indice->quantidade &&
+           memcmp(entrada + 12, ASSINATURA_INDICE, 4) == 0;
+}
+
+/**
+ * @brief Lê uma quantidade de bytes de uma posição do arquivo.
+ *
+ * @param arquivo Arquivo posicionável.
+ * @param posicao Posição, contada do início do arquivo.
+ * @param destino Região de saída.
+ * @param quantidade Quantidade de bytes.
+ * @return int 1 em caso de sucesso ou 0 se a leitura falhar.
+ */
+int ler_na_posicao(FILE *arquivo, unsigned long long posicao, unsigned char *destino, size_t quantidade){
+    return posicionar_arquivo(arquivo, posicao, SEEK_SET) == 0 && fread(destino, 1, quantidade, arquivo) == quantidade;
+}
+
+/**
+ * @brief Descompacta só um trecho dos dados originais de um arquivo em blocos com índice.
+ *
+ * Lê o rodapé, acha os blocos que cobrem o trecho e descompacta só esses, conferindo a soma de
+ * verificação de cada um.
+ *
+ * @param arquivo_entrada Arquivo compactado (precisa ser posicionável, não pode ser um pipe).
+ * @param arquivo_saida Arquivo de saída.
+ * @param inicio Posição do primeiro byte do trecho nos dados originais.
+ * @param quantidade Quantidade de bytes do trecho (é limitada ao fim dos dados).
+ * @return long long Quantidade de bytes gravados ou -1 se o arquivo não tiver índice ou for inválido.
+ */
+long long descompactar_intervalo(FILE *arquivo_entrada, FILE *arquivo_saida, unsigned long long inicio, unsigned long long quantidade){
+    unsigned char cabecalho[8], fim[TAM_FIM_INDICE];
+    if(!ler_na_posicao(arquivo_entrada, 0, cabecalho, 8) ||
+       memcmp(cabecalho, ASSINATURA, 2) != 0 || cabecalho[2] != FORMATO_BLOCOS || !(cabecalho[3] & COM_INDICE))
+        return -1;
+
+    unsigned long tam_bloco = extrair_u32(cabecalho + 4);
+    if(tam_bloco == 0 || tam_bloco > MAX_BLOCO_HUFFMAN ||
+       posicionar_arquivo(arquivo_entrada, 0, SEEK_END) != 0)
+        return -1;
+
+    long long tam_arquivo = posicao_arquivo(arquivo_entrada);
+    if(tam_arquivo < 8 + 4 + TAM_FIM_INDICE ||
+       !ler_na_posicao(arquivo_entrada, tam_arquivo - TAM_FIM_INDICE, fim, TAM_FIM_INDICE) ||
+       memcmp(fim + 12, ASSINATURA_INDICE, 4) != 0)
+        return -1;
+
+    unsigned long long tam_total = extrair_u64(fim);
+    unsigned long n_blocos = extrair_u32(fim + 8);
+    unsigned long long inicio_indice = tam_arquivo - TAM_FIM_INDICE - (unsigned long long)n_blocos * TAM_ENTRADA_INDICE;
+    if((unsigned long long)n_blocos * TAM_ENTRADA_INDICE > (unsigned long long)tam_arquivo - 8 - 4 - TAM_FIM_INDICE ||
+       tam_total > (unsigned long long)n_blocos * tam_bloco)
+        return -1;
+
+    if(inicio >= tam_total) return 0;
+    if(quantidade > tam_total - inicio) quantidade = tam_total - inicio;
+    if(quantidade == 0) return 0;
+
+    unsigned char *original = malloc(tam_bloco);
+    unsigned char *compactado = malloc(limite_bloco_canonico(tam_bloco));
+    if(!original || !compactado){
+        free(original);
+        free(compactado);
+        return -1;
+    }
+
+    unsigned long primeiro = inicio / tam_bloco, ultimo = (inicio + quantidade - 1) / tam_bloco;
+    long long gravados = 0;
+    int ok = 1;
+
+    for(unsigned long b = primeiro; b <= ultimo && ok; b++){
+        unsigned char entrada[TAM_ENTRADA_INDICE], indice_bloco[8];
+        ok = ler_na_posicao(arquivo_entrada, inicio_indice + (unsigned long long)b * TAM_ENTRADA_INDICE, entrada, TAM_ENTRADA_INDICE);
+
+        unsigned long long posicao = extrair_u64(entrada);
+        ok = ok && posicao >= 8 && posicao + 8 <= inicio_indice &&
+             ler_na_posicao(arquivo_entrada, posicao, indice_bloco, 8);
+
+        // Todos os blocos têm tam_bloco bytes originais, menos o último
+        unsigned long tam_original = extrair_u32(indice_bloco), tam_compactado = extrair_u32(indice_bloco + 4);
+        unsigned long esperado = b + 1 < n_blocos ? tam_bloco : tam_total - (unsigned long long)b * tam_bloco;
+        ok = ok && tam_original == esperado && tam_compactado <= limite_bloco_canonico(tam_bloco) &&
+             posicao + 8 + tam_compactado <= inicio_indice &&
+             fread(compactado, 1, tam_compactado, arquivo_entrada) == tam_compactado &&
+             descompactar_bloco_memoria(compactado, tam_compactado, original, tam_original) &&
+             soma_verificacao(original, tam_original) == extrair_u32(entrada + 8);
+
+        if(ok){
+            unsigned long long inicio_bloco = (unsigned long long)b * tam_bloco;
+            size_t de = inicio > inicio_bloco ? inicio - inicio_bloco : 0;
+            size_t ate = inicio + quantidade < inicio_bloco + tam_original ? inicio + quantidade - inicio_bloco : tam_original;
+            ok = fwrite(original + de, 1, ate - de, arquivo_saida) == ate - de;
+            gravados += ate - de;
+        }
+    }
+
+    free(original);
+    free(compactado);
+    return ok ? gravados : -1;
+}
+
+#endif
@@ -0,0 +1,381 @@
+/**
+ * @file largo.h
+ * @brief Modo com alfabeto de 16 bits: cada símbolo é um par de bytes (little-endian) da entrada.
+ *
+ * Para dados já divididos em tokens ou colunas de inteiros pequenos, o valor inteiro é o que se
+ * repete, não os seus bytes; codificar cada valor de 16 bits como um símbolo aproveita isso. O
+ * cabeçalho do formato antigo (3 bits de lixo, 13 bits de árvore) e o canônico (até 256 símbolos)
+ * não comportam esse alfabeto, então este formato usa campos largos.
+ *
+ * Formato do arquivo (versão FORMATO_LARGO):
+ * - 2 bytes: assinatura "HF";
+ * - 1 byte: versão do formato;
+ * - 1 byte: bytes por símbolo (sempre 2);
+ * - 8 bytes: quantidade de símbolos codificados;
+ * - 1 byte: quantidade de bytes que sobram no fim da entrada (0 ou 1), seguido desses bytes;
+ * - 4 bytes: quantidade de símbolos presentes (0 a 65536);
+ * - 1 byte: largura, em bits, de cada tamanho de código gravado;
+ * - lista dos símbolos presentes, 2 bytes cada (se forem até LIMITE_LISTA_LARGA), ou mapa de
+ *   8192 bytes com um bit por símbolo;
+ * - tamanhos dos códigos dos símbolos presentes, empacotados com a largura acima;
+ * - dados codificados, com o último byte completado com zeros.
+ *
+ * Como a quantidade de símbolos é gravada, o lixo do último byte não precisa de campo próprio.
+ */
+
+#ifndef LARGO_H
+#define LARGO_H
+
+#include "canonico.h"
+
+/**
+ * @def TAM_ALFABETO_LARGO
+ * @brief Quantidade de símbolos do alfabeto de 16 bits.
+ */
+#define TAM_ALFABETO_LARGO 65536
+
+/**
+ * @def BYTES_SIMBOLO_LARGO
+ * @brief Bytes da entrada que formam cada símbolo.
+ */
+#define BYTES_SIMBOLO_LARGO 2
+
+/**
+ * @def LIMITE_LISTA_LARGA
+ * @brief Até esta quantidade de símbolos presentes, a lista (2 bytes por símbolo) não é maior que o mapa.
+ */
+#define LIMITE_LISTA_LARGA (TAM_ALFABETO_LARGO / 8 / 2)
+
+/**
+ * @brief Calcula o tamanho, em bytes, da tabela larga de tamanhos.
+ *
+ * @param tamanhos Tamanho do código de cada um dos 65536 símbolos.
+ * @param largura Ponteiro para guardar a largura de cada tamanho gravado.
+ * @param presentes Ponteiro para guardar a quantidade de símbolos presentes.
+ * @return unsigned long Tamanho da tabela em bytes.
+ */
+unsigned long tamanho_tabela_larga(const unsigned char *tamanhos, int *largura, long *presentes){
+    int maior = 0;
+    *presentes = 0;
+
+    for(long i = 0; i < TAM_ALFABETO_LARGO; i++){
+        if(tamanhos[i]){
+            (*presentes)++;
+            if(tamanhos[i] > maior) maior = tamanhos[i];
+        }
+    }
+
+    *largura = 1;
+    while((1 << *largura) <= maior)
+        (*largura)++;
+
+    unsigned long lista = *presentes <= LIMITE_LISTA_LARGA ? 2 * *presentes : TAM_ALFABETO_LARGO / 8;
+    return 5 + lista + ((unsigned long)*presentes * *largura + 7) / 8;
+}
+
+/**
+ * @brief Escreve a tabela larga de tamanhos: presentes, largura, símbolos e tamanhos empacotados.
+ *
+ * @param escritor Escritor de saída.
+ * @param tamanhos Tamanho do código de cada um dos 65536 símbolos.
+ * @return unsigned long Tamanho da tabela em bytes.
+ */
+unsigned long salvar_tabela_larga(ESCRITOR *escritor, const unsigned char *tamanhos){
+    int largura;
+    long presentes;
+    unsigned long tam_tabela = tamanho_tabela_larga(tamanhos, &largura, &presentes);
+
+    escrever_u32(escritor, presentes);
+    escrever_byte(escritor, largura);
+
+    if(presentes <= LIMITE_LISTA_LARGA){
+        for(long i = 0; i < TAM_ALFABETO_LARGO; i++){
+            if(tamanhos[i]){
+                escrever_byte(escritor, i >> 8);
+                escrever_byte(escritor, i);
+            }
+        }
+    }else{
+        unsigned char mapa[TAM_ALFABETO_LARGO / 8] = {0};
+        for(long i = 0; i < TAM_ALFABETO_LARGO; i++)
+            if(tamanhos[i]) mapa[i >> 3] |= 0x80 >> (i & 7);
+        escrever_bytes(escritor, mapa, sizeof(mapa));
+    }
+
+    ESCRITOR_BITS escritor_bits;
+    iniciar_escritor_bits(&escritor_bits, escritor);
+    for(long i = 0; i < TAM_ALFABETO_LARGO; i++)
+        if(tamanhos[i]) escrever_bits(&escritor_bits, tamanhos[i], largura);
+    finalizar_bits(&escritor_bits);
+
+    return tam_tabela;
+}
+
+/**
+ * @brief Lê uma tabela gravada por salvar_tabela_larga.
+ *
+ * @param leitor Leitor posicionado no início da tabela.
+ * @param tamanhos Vetor de 65536 tamanhos a ser preenchido.
+ * @return long Tamanho da tabela em bytes ou -1 se ela for inválida (inclusive se violar Kraft).
+ */
+long ler_tabela_larga(LEITOR *leitor, unsigned char *tamanhos){
+    unsigned long presentes;
+    unsigned char largura, byte;
+
+    if(!ler_u32(leitor, &presentes) || !ler_byte(leitor, &largura) ||
+       presentes > TAM_ALFABETO_LARGO || largura < 1 || largura > 7)
+        return -1;
+
+    memset(tamanhos, 0, TAM_ALFABETO_LARGO);
+
+    // A lista é guardada primeiro em tamanhos como marcação; os tamanhos reais vêm depois, na ordem dos símbolos
+    if(presentes <= LIMITE_LISTA_LARGA){
+        long anterior = -1;
+        for(unsigned long i = 0; i < presentes; i++){
+            unsigned char par[2];
+            if(ler_bytes(leitor, par, 2) != 2) return -1;
+
+            long simbolo = (par[0] << 8) | par[1];
+            if(simbolo <= anterior) return -1;
+            tamanhos[simbolo] = 1;
+            anterior = simbolo;
+        }
+    }else{
+        unsigned long contados = 0;
+        for(long i = 0; i < TAM_ALFABETO_LARGO / 8; i++){
+            if(!ler_byte(leitor, &byte)) return -1;
+            for(int b = 0; b < 8; b++){
+                if(byte & (0x80 >> b)){
+                    tamanhos[i * 8 + b] = 1;
+                    contados++;
+                }
+            }
+        }
+        if(contados != presentes) return -1;
+    }
+
+    LEITOR_BITS leitor_bits;
+    iniciar_leitor_bits(&leitor_bits, leitor);
+    for(long i = 0; i < TAM_ALFABETO_LARGO; i++){
+        if(!tamanhos[i]) continue;
+
+        if(leitor_bits.quantidade < largura){
+            if(!ler_byte(leitor, &byte)) return -1;
+            leitor_bits.acumulador |= (unsigned long long)byte << (56 - leitor_bits.quantidade);
+            leitor_bits.quantidade += 8;
+        }
+        tamanhos[i] = espiar_bits(&leitor_bits, largura);
+        consumir_bits(&leitor_bits, largura);
+        if(tamanhos[i] == 0 || tamanhos[i] > MAX_BITS_CODIGO) return -1;
+    }
+    if(!verificar_kraft(tamanhos, TAM_ALFABETO_LARGO))
+        return -1;
+
+    unsigned long lista = presentes <= LIMITE_LISTA_LARGA ? 2 * presentes : TAM_ALFABETO_LARGO / 8;
+    return 5 + lista + (presentes * largura + 7) / 8;
+}
+
+/**
+ * @brief Codifica no modo de 16 bits os dados de um leitor, em duas passadas (contagem e codificação).
+ *
+ * O package-merge (quando max_bits > 0) guarda max_bits níveis de até 2n itens de 16 bytes: com
+ * todos os 65536 símbolos presentes e max_bits = 16, são 32 MiB durante a construção dos códigos.
+ *
+ * @param leitor Leitor posicionado no início dos dados originais (é reiniciado depois da contagem).
+ * @param escritor Escritor de saída.
+ * @param tam_arq Quantidade de bytes a codificar.
+ * @param max_bits Tamanho máximo dos códigos (0 para não limitar).
+ * @param presentes Ponteiro para guardar a quantidade de símbolos distintos (pode ser NULL).
+ * @return long Tamanho do cabeçalho em bytes ou -1 em caso de erro.
+ */
+long codificar_largo_leitor(LEITOR *leitor, ESCRITOR *escritor, unsigned long long tam_arq, int max_bits, long *presentes){
+    unsigned long *frequencia = calloc(TAM_ALFABETO_LARGO, sizeof(unsigned long));
+    unsigned char *tamanhos = malloc(TAM_ALFABETO_LARGO);
+    CODIGO *codigos = malloc(TAM_ALFABETO_LARGO * sizeof(CODIGO));
+    if(!frequencia || !tamanhos || !codigos){
+        free(frequencia);
+        free(tamanhos);
+        free(codigos);
+        return -1;
+    }
+
+    // Um símbolo pode ficar dividido entre dois blocos do leitor: o primeiro byte espera em "metade"
+    unsigned long long n_simbolos = tam_arq / BYTES_SIMBOLO_LARGO, restante = tam_arq;
+    int metade = -1;
+    while(restante > 0 && recarregar_leitor(leitor) > 0){
+        size_t n = leitor->tamanho < restante ? leitor->tamanho : restante, i = 0;
+        if(metade >= 0){
+            frequencia[metade | (leitor->dados[0] << 8)]++;
+            metade = -1;
+            i = 1;
+        }
+        for(; i + 1 < n; i += 2)
+            frequencia[leitor->dados[i] | (leitor->dados[i + 1] << 8)]++;
+        if(i < n) metade = leitor->dados[i];
+        restante -= n;
+    }
+
+    reiniciar_leitor(leitor);
+
+    // Com um tamanho ímpar, o último byte não forma símbolo e vai direto para o cabeçalho
+    unsigned char sobra[BYTES_SIMBOLO_LARGO];
+    int n_sobra = tam_arq % BYTES_SIMBOLO_LARGO;
+    if(n_sobra > 0) sobra[0] = metade;
+    if(restante > 0 || (n_sobra > 0 && metade < 0)){
+        free(frequencia);
+        free(tamanhos);
+        free(codigos);
+        return -1;
+    }
+
+    int ok = max_bits > 0 ? tamanhos_limitados(frequencia, TAM_ALFABETO_LARGO, max_bits, tamanhos)
+                          : tamanhos_huffman(frequencia, TAM_ALFABETO_LARGO, tamanhos) ||
+                            tamanhos_limitados(frequencia, TAM_ALFABETO_LARGO, MAX_BITS_CODIGO, tamanhos);
+    free(frequencia);
+    if(!ok){
+        free(tamanhos);
+        free(codigos);
+        return -1;
+    }
+    gerar_codigos_canonicos(tamanhos, codigos, TAM_ALFABETO_LARGO);
+
+    unsigned char campos[12] = {ASSINATURA[0], ASSINATURA[1], FORMATO_LARGO, BYTES_SIMBOLO_LARGO};
+    for(int i = 0; i < 8; i++)
+        campos[4 + i] = n_simbolos >> (56 - 8 * i);
+    escrever_bytes(escritor, campos, 12);
+    escrever_byte(escritor, n_sobra);
+    escrever_bytes(escritor, sobra, n_sobra);
+
+    int largura;
+    long distintos;
+    tamanho_tabela_larga(tamanhos, &largura, &distintos);
+    if(presentes) *presentes = distintos;
+    long tam_cabecalho = 13 + n_sobra + salvar_tabela_larga(escritor, tamanhos);
+    free(tamanhos);
+
+    ESCRITOR_BITS escritor_bits;
+    iniciar_escritor_bits(&escritor_bits, escritor);
+
+    restante = n_simbolos * BYTES_SIMBOLO_LARGO;
+    metade = -1;
+    while(restante > 0 && recarregar_leitor(leitor) > 0){
+        size_t n = leitor->tamanho < restante ? leitor->tamanho : restante, i = 0;
+        if(metade >= 0){
+            const CODIGO *codigo = &codigos[metade | (leitor->dados[0] << 8)];
+            escrever_bits(&escritor_bits, codigo->bits, codigo->tamanho);
+            metade = -1;
+            i = 1;
+        }
+        for(; i + 1 < n; i += 2){
+            const CODIGO *codigo = &codigos[leitor->dados[i] | (leitor->dados[i + 1] << 8)];
+            escrever_bits(&escritor_bits, codigo->bits, codigo->tamanho);
+        }
+        if(i < n) metade = leitor->dados[i];
+        restante -= n;
+    }
+    finalizar_bits(&escritor_bits);
+
+    free(codigos);
+    return escritor->erro ? -1 : tam_cabecalho;
+}
+
+/**
+ * @brief Compacta um arquivo no modo de 16 bits.
+ *
+ * @param leitor Leitor do arquivo original, posicionado no início.
+ * @param arquivo_saida Arquivo de saída.
+ * @param tam_arq Tamanho do arquivo original.
+ * @param tam_bloco Tamanho dos blocos de escrita (0 usa TAM_BLOCO_IO).
+ * @param presentes Ponteiro para guardar a quantidade de símbolos distintos (pode ser NULL).
+ * @return long Tamanho do cabeçalho em bytes ou -1 em caso de erro.
+ */
+long codificar_largo(LEITOR *leitor, FILE *arquivo_saida, unsigned long long tam_arq, size_t tam_bloco, long *presentes){
+    ESCRITOR escritor;
+    if(!iniciar_escritor(&escritor, arquivo_saida, tam_bloco))
+        return -1;
+
+    long tam_cabecalho = codificar_largo_leitor(leitor, &escritor, tam_arq, 0, presentes);
+
+    liberar_escritor(&escritor);
+    return escritor.erro ? -1 : tam_cabecalho;
+}
+
+/**
+ * @brief Decodifica dados no modo de 16 bits de um leitor (arquivo ou memória).
+ *
+ * @param leitor Leitor posicionado logo depois da assinatura e da versão.
+ * @param escritor Escritor de saída.
+ * @param tam_comprimido Tamanho total dos dados compactados, contando assinatura e versão.
+ * @return int 1 em caso de sucesso ou 0 se os dados forem inválidos.
+ */
+int decodificar_largo_leitor(LEITOR *leitor, ESCRITOR *escritor, unsigned long long tam_comprimido){
+    unsigned char campos[10], sobra[BYTES_SIMBOLO_LARGO];
+    if(ler_bytes(leitor, campos, 10) != 10 || campos[0] != BYTES_SIMBOLO_LARGO || campos[9] >= BYTES_SIMBOLO_LARGO ||
+       ler_bytes(leitor, sobra, campos[9]) != campos[9])
+        return 0;
+
+    unsigned long long n_simbolos = 0;
+    for(int i = 1; i <= 8; i++)
+        n_simbolos = (n_simbolos << 8) | campos[i];
+
+    unsigned char *tamanhos = malloc(TAM_ALFABETO_LARGO);
+    CODIGO *codigos = malloc(TAM_ALFABETO_LARGO * sizeof(CODIGO));
+    long tam_tabela = tamanhos && codigos ? ler_tabela_larga(leitor, tamanhos) : -1;
+    unsigned long long tam_cabecalho = 13 + campos[9] + tam_tabela;
+    if(tam_tabela < 0 || tam_cabecalho > tam_comprimido){
+        free(tamanhos);
+        free(codigos);
+        return 0;
+    }
+
+    gerar_codigos_canonicos(tamanhos, codigos, TAM_ALFABETO_LARGO);
+    free(tamanhos);
+
+    TABELA_DECODIFICACAO tabela;
+    int ok = construir_tabela(&tabela, codigos, TAM_ALFABETO_LARGO);
+    free(codigos);
+    if(!ok){
+        escrever_bytes(escritor, sobra, campos[9]);
+        return n_simbolos == 0 && !escritor->erro;
+    }
+
+    LEITOR_BITS leitor_bits;
+    iniciar_leitor_bits(&leitor_bits, leitor);
+    unsigned long long restante = (tam_comprimido - tam_cabecalho) * 8;
+
+    for(unsigned long long i = 0; i < n_simbolos; i++){
+        int simbolo = decodificar_simbolo(&tabela, &leitor_bits, &restante);
+        if(simbolo < 0){
+            ok = 0;
+            break;
+        }
+        escrever_byte(escritor, simbolo);
+        escrever_byte(escritor, simbolo >> 8);
+    }
+    escrever_bytes(escritor, sobra, campos[9]);
+
+    liberar_tabela(&tabela);
+    return ok && !escritor->erro;
+}
+
+/**
+ * @brief Descompacta um arquivo no modo de 16 bits.
+ *
+ * @param leitor Leitor do arquivo compactado, posicionado logo depois da assinatura e da versão.
+ * @param arquivo_saida Arquivo de saída.
+ * @param tam_arq Tamanho total do arquivo compactado.
+ * @param tam_bloco Tamanho dos blocos de escrita (0 usa TAM_BLOCO_IO).
+ * @return int 1 em caso de sucesso ou 0 se o arquivo for inválido.
+ */
+int decodificar_largo(LEITOR *leitor, FILE *arquivo_saida, unsigned long long tam_arq, size_t tam_bloco){
+    ESCRITOR escritor;
+    if(!iniciar_escritor(&escritor, arquivo_saida, tam_bloco))
+        return 0;
+
+    int ok = decodificar_largo_leitor(leitor, &escritor, tam_arq);
+
+    liberar_escritor(&escritor);
+    return ok && !escritor.erro;
+}
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * @file limitado.h
+ * @brief Construção de códigos de Huffman com tamanho máximo (algoritmo package-merge).
+ *
+ * O package-merge encontra, entre todos os códigos de prefixo com no máximo max_bits bits,
+ * aquele de menor tamanho total para as frequências dadas. Não é um rebalanceamento heurístico
+ * da árvore: o resultado é ótimo sob a restrição.
+ */
+
+#ifndef LIMITADO_H
+#define LIMITADO_H
+
+#include "construcao.h"
+
+/**
+ * @struct ITEM_PM
+ * @brief Item de uma lista do package-merge: uma folha (símbolo) ou um pacote com dois itens do nível abaixo.
+ *
+ * - peso: frequência da folha ou soma dos pesos do pacote.
+ * - simbolo: símbolo da folha ou -1 para pacotes.
+ */
+typedef struct{
+    unsigned long long peso;
+    int simbolo;
+}ITEM_PM;
+
+/**
+ * @brief Compara dois itens pelo peso e, no empate, pelo símbolo (usada no qsort).
+ */
+int comparar_itens_pm(const void *a, const void *b){
+    const ITEM_PM *x = a, *y = b;
+    if(x->peso != y->peso) return x->peso < y->peso ? -1 : 1;
+    return x->simbolo - y->simbolo;
+}
+
+/**
+ * @brief Calcula os tamanhos dos códigos ótimos limitados a max_bits bits.
+ *
+ * Cada nível guarda as folhas intercaladas, em ordem de peso, com os pacotes formados pelos pares
+ * consecutivos do nível anterior. Os 2n - 2 primeiros itens do último nível indicam os tamanhos:
+ * cada vez que uma folha aparece entre os itens escolhidos, seu código cresce um bit, e os pacotes
+ * escolhidos em um nível escolhem os dois itens correspondentes no nível seguinte.
+ *
+ * @param frequencia Frequência de cada símbolo.
+ * @param n_simbolos Quantidade de símbolos do alfabeto.
+ * @param max_bits Tamanho máximo dos códigos (1 a MAX_BITS_CODIGO).
+ * @param tamanhos Vetor de saída com o tamanho de cada símbolo.
+ * @return int 1 em caso de sucesso ou 0 se max_bits não comporta todos os símbolos ou faltar memória.
+ */
+int tamanhos_limitados(const unsigned long *frequencia, int n_simbolos, int max_bits, unsigned char *tamanhos){
+    memset(tamanhos, 0, n_simbolos);
+    if(max_bits < 1 || max_bits > MAX_BITS_CODIGO) return 0;
+
+    int n = 0;
+    for(int i = 0; i < n_simbolos; i++)
+        if(frequencia[i]) n++;
+
+    if(n == 0) return 1;
+    if(n == 1){
+        for(int i = 0; i < n_simbolos; i++)
+            if(frequencia[i]) tamanhos[i] = 1;
+        return 1;
+    }
+    if(max_bits < 63 && (unsigned long long)n > (1ULL << max_bits)) return 0;
+
+    ITEM_PM *folhas = malloc(n * sizeof(ITEM_PM));
+    ITEM_PM *niveis = malloc((size_t)max_bits * (2 * n) * sizeof(ITEM_PM));
+    int *tamanho_nivel = malloc(max_bits * sizeof(int));
+    if(!folhas || !niveis || !tamanho_nivel){
+        free(folhas);
+        free(niveis);
+        free(tamanho_nivel);
+        return 0;
+    }
+
+    for(int i = 0, k = 0; i < n_simbolos; i++){
+        if(frequencia[i]){
+            folhas[k].peso = frequencia[i];
+            folhas[k].simbolo = i;
+            k++;
+        }
+    }
+    qsort(folhas, n, sizeof(ITEM_PM), comparar_itens_pm);
+
+    // Com as folhas já ordenadas, a árvore sem limite sai em tempo linear; se ela respeitar o limite, é a resposta ótima
+    unsigned long long *pesos = malloc(n * sizeof(unsigned long long));
+    int *simbolos = malloc(n * sizeof(int));
+    int pronto = 0;
+
+    if(pesos && simbolos){
+        int maior = 0;
+        for(int i = 0; i < n; i++){
+            pesos[i] = folhas[i].peso;
+            simbolos[i] = folhas[i].simbolo;
+        }
+        if(tamanhos_duas_filas(pesos, simbolos, n, tamanhos)){
+            for(int i = 0; i < n; i++)
+                if(tamanhos[simbolos[i]] > maior) maior = tamanhos[simbolos[i]];
+            pronto = maior <= max_bits;
+        }
+    }
+    free(pesos);
+    free(simbolos);
+
+    if(pronto){
+        free(folhas);
+        free(niveis);
+        free(tamanho_nivel);
+        return 1;
+    }
+    memset(tamanhos, 0, n_simbolos);
+
+    // O nível max_bits - 1 (o mais profundo) tem apenas as folhas; cada nível acima junta as folhas com os pacotes
+    memcpy(niveis + (size_t)(max_bits - 1) * (2 * n), folhas, n * sizeof(ITEM_PM));
+    tamanho_nivel[max_bits - 1] = n;
+
+    for(int d = max_bits - 2; d >= 0; d--){
+        ITEM_PM *anterior = niveis + (size_t)(d + 1) * (2 * n);
+        ITEM_PM *atual = niveis + (size_t)d * (2 * n);
+        int pacotes = tamanho_nivel[d + 1] / 2;
+        int f = 0, p = 0, k = 0;
+
+        while(f < n || p < pacotes){
+            unsigned long long peso_pacote = p < pacotes ? anterior[2 * p].peso + anterior[2 * p + 1].peso : 0;
+
+            if(p >= pacotes || (f < n && folhas[f].peso <= peso_pacote)){
+                atual[k++] = folhas[f++];
+            }else{
+                atual[k].peso = peso_pacote;
+                atual[k].simbolo = -1;
+                k++;
+                p++;
+            }
+        }
+        tamanho_nivel[d] = k;
+    }
+
+    int escolhidos = 2 * n - 2;
+    for(int d = 0; d < max_bits && escolhidos > 0; d++){
+        ITEM_PM *atual = niveis + (size_t)d * (2 * n);
+        int pacotes = 0;
+
+        for(int k = 0; k < escolhidos; k++){
+            if(atual[k].simbolo >= 0)
+                tamanhos[atual[k].simbolo]++;
+            else
+                pacotes++;
+        }
+        escolhidos = 2 * pacotes;
+    }
+
+    free(folhas);
+    free(niveis);
+    free(tamanho_nivel);
+    return 1;
+}
+
+#endif
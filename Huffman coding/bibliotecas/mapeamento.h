@@ -0,0 +1,134 @@
+/**
+ * @file mapeamento.h
+ * @brief Leitura de arquivos mapeados na memória (mmap no POSIX, MapViewOfFile no Windows).
+ *
+ * Com o arquivo mapeado, o leitor percorre as páginas do próprio cache do sistema, sem copiar os
+ * dados para um bloco intermediário; as duas passadas da compactação (contagem e codificação) e a
+ * descompactação leem direto do mapeamento. Quando o arquivo não pode ser mapeado (pipes, por
+ * exemplo), o leitor volta a ler em blocos com fread.
+ */
+
+#ifndef MAPEAMENTO_H
+#define MAPEAMENTO_H
+
+#include "buffer_io.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * @struct ARQUIVO_MAPEADO
+ * @brief Região de um arquivo mapeada na memória.
+ *
+ * - dados: início do mapeamento (NULL se o arquivo não foi mapeado ou está vazio).
+ * - tamanho: tamanho do arquivo em bytes.
+ * - mapeado: indica que existe um mapeamento a ser desfeito.
+ */
+typedef struct{
+    unsigned char *dados;
+    size_t tamanho;
+    int mapeado;
+}ARQUIVO_MAPEADO;
+
+/**
+ * @brief Mapeia um arquivo aberto inteiro na memória, apenas para leitura.
+ *
+ * @param mapa Ponteiro para o mapeamento a ser preenchido.
+ * @param arquivo Arquivo aberto em modo binário.
+ * @return int 1 em caso de sucesso (arquivos vazios não geram mapeamento) ou 0 se não foi possível mapear.
+ */
+int mapear_arquivo(ARQUIVO_MAPEADO *mapa, FILE *arquivo){
+    mapa->dados = NULL;
+    mapa->tamanho = 0;
+    mapa->mapeado = 0;
+
+#ifdef _WIN32
+    HANDLE manipulador = (HANDLE)_get_osfhandle(_fileno(arquivo));
+    LARGE_INTEGER tamanho;
+    if(manipulador == INVALID_HANDLE_VALUE || GetFileType(manipulador) != FILE_TYPE_DISK || !GetFileSizeEx(manipulador, &tamanho))
+        return 0;
+    if((unsigned long long)tamanho.QuadPart > (size_t)-1)
+        return 0;
+
+    mapa->tamanho = (size_t)tamanho.QuadPart;
+    if(mapa->tamanho == 0) return 1;
+
+    HANDLE objeto = CreateFileMapping(manipulador, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(!objeto) return 0;
+
+    // A visão mantém o objeto de mapeamento vivo até UnmapViewOfFile
+    mapa->dados = MapViewOfFile(objeto, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(objeto);
+#else
+    struct stat info;
+    if(fstat(fileno(arquivo), &info) != 0 || !S_ISREG(info.st_mode))
+        return 0;
+    if((unsigned long long)info.st_size > (size_t)-1)
+        return 0;
+
+    mapa->tamanho = info.st_size;
+    if(mapa->tamanho == 0) return 1;
+
+    void *dados = mmap(NULL, mapa->tamanho, PROT_READ, MAP_PRIVATE, fileno(arquivo), 0);
+    if(dados == MAP_FAILED) return 0;
+
+    posix_madvise(dados, mapa->tamanho, POSIX_MADV_SEQUENTIAL);
+    mapa->dados = dados;
+#endif
+
+    mapa->mapeado = mapa->dados != NULL;
+    return mapa->mapeado;
+}
+
+/**
+ * @brief Desfaz o mapeamento de um arquivo.
+ *
+ * @param mapa Ponteiro para o mapeamento.
+ */
+void desmapear_arquivo(ARQUIVO_MAPEADO *mapa){
+    if(mapa->mapeado){
+#ifdef _WIN32
+        UnmapViewOfFile(mapa->dados);
+#else
+        munmap(mapa->dados, mapa->tamanho);
+#endif
+    }
+    mapa->dados = NULL;
+    mapa->tamanho = 0;
+    mapa->mapeado = 0;
+}
+
+/**
+ * @brief Inicializa um leitor sobre o arquivo mapeado ou, se não for possível mapear, em blocos.
+ *
+ * @param leitor Ponteiro para o leitor a ser inicializado.
+ * @param mapa Ponteiro para o mapeamento (liberado depois por fechar_leitor_mapeado).
+ * @param arquivo Arquivo de origem, posicionado no início.
+ * @param tam_bloco Tamanho dos blocos quando o arquivo não é mapeado (0 usa TAM_BLOCO_IO).
+ * @return int 1 em caso de sucesso ou 0 se faltar memória.
+ */
+int abrir_leitor_mapeado(LEITOR *leitor, ARQUIVO_MAPEADO *mapa, FILE *arquivo, size_t tam_bloco){
+    if(mapear_arquivo(mapa, arquivo)){
+        iniciar_leitor_memoria(leitor, mapa->dados, mapa->tamanho);
+        return 1;
+    }
+    return iniciar_leitor(leitor, arquivo, tam_bloco);
+}
+
+/**
+ * @brief Libera o leitor e o mapeamento criados por abrir_leitor_mapeado. O arquivo continua aberto.
+ *
+ * @param leitor Ponteiro para o leitor.
+ * @param mapa Ponteiro para o mapeamento.
+ */
+void fechar_leitor_mapeado(LEITOR *leitor, ARQUIVO_MAPEADO *mapa){
+    liberar_leitor(leitor);
+    desmapear_arquivo(mapa);
+}
+
+#endif
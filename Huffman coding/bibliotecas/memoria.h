@@ -0,0 +1,249 @@
+/**
+ * @file memoria.h
+ * @brief Compactação e descompactação entre regiões de memória, sem arquivos.
+ *
+ * Gera o mesmo formato do modo em blocos (versão FORMATO_BLOCOS, descrito em blocos.h), em uma só
+ * thread; o resultado pode ser descompactado pelo programa e vice-versa. Cada bloco é um fluxo
+ * canônico ou, se pedido, quatro fluxos intercalados (fluxos.h), que descompactam mais rápido. A saída é sempre uma região
+ * fornecida pelo chamador: limite_compactado e tamanho_descompactado informam quanto espaço reservar.
+ *
+ * Esta biblioteca não depende de threads nem do Windows e não imprime nada.
+ */
+
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include "fluxos.h"
+
+/**
+ * @def TAM_BLOCO_HUFFMAN
+ * @brief Tamanho padrão, em bytes, dos blocos independentes (1 MiB).
+ */
+#define TAM_BLOCO_HUFFMAN (1 << 20)
+
+/**
+ * @def MAX_BLOCO_HUFFMAN
+ * @brief Maior tamanho de bloco aceito, para que os tamanhos caibam nos campos de 32 bits.
+ */
+#define MAX_BLOCO_HUFFMAN (1UL << 30)
+
+/**
+ * @brief Retorna o maior tamanho possível de um bloco canônico compactado.
+ *
+ * Os códigos de Huffman (limitados ou não) nunca gastam mais que 8 bits por byte, então o bloco
+ * ocupa no máximo o cabeçalho canônico completo (263 bytes) mais os dados originais. Com quatro
+ * fluxos, o cabeçalho tem 12 bytes a mais e cada fluxo pode completar um byte.
+ *
+ * @param tam_original Tamanho original do bloco.
+ * @return size_t Tamanho máximo do bloco compactado.
+ */
+size_t limite_bloco_canonico(size_t tam_original){
+    return tam_original + 280;
+}
+
+/**
+ * @brief Grava um inteiro de 32 bits em um vetor de bytes, do byte mais significativo para o menos significativo.
+ *
+ * @param destino Vetor com pelo menos 4 bytes.
+ * @param valor Valor a ser gravado.
+ */
+void gravar_u32(unsigned char *destino, unsigned long valor){
+    destino[0] = valor >> 24;
+    destino[1] = valor >> 16;
+    destino[2] = valor >> 8;
+    destino[3] = valor;
+}
+
+/**
+ * @brief Lê um inteiro de 32 bits de um vetor de bytes gravado por gravar_u32.
+ *
+ * @param origem Vetor com pelo menos 4 bytes.
+ * @return unsigned long Valor lido.
+ */
+unsigned long extrair_u32(const unsigned char *origem){
+    return ((unsigned long)origem[0] << 24) | ((unsigned long)origem[1] << 16) | ((unsigned long)origem[2] << 8) | origem[3];
+}
+
+/**
+ * @brief Grava um inteiro de 64 bits em um vetor de bytes, do byte mais significativo para o menos significativo.
+ *
+ * @param destino Vetor com pelo menos 8 bytes.
+ * @param valor Valor a ser gravado.
+ */
+void gravar_u64(unsigned char *destino, unsigned long long valor){
+    gravar_u32(destino, valor >> 32);
+    gravar_u32(destino + 4, valor & 0xFFFFFFFFUL);
+}
+
+/**
+ * @brief Lê um inteiro de 64 bits de um vetor de bytes gravado por gravar_u64.
+ *
+ * @param origem Vetor com pelo menos 8 bytes.
+ * @return unsigned long long Valor lido.
+ */
+unsigned long long extrair_u64(const unsigned char *origem){
+    return ((unsigned long long)extrair_u32(origem) << 32) | extrair_u32(origem + 4);
+}
+
+/**
+ * @brief Compacta um bloco em memória como um fluxo canônico completo (com assinatura e versão).
+ *
+ * @param origem Bytes originais do bloco.
+ * @param tam_origem Quantidade de bytes originais.
+ * @param destino Região de saída.
+ * @param capacidade Tamanho da região de saída (limite_bloco_canonico sempre basta).
+ * @param max_bits Tamanho máximo dos códigos (0 sem limite).
+ * @param quatro_fluxos Indica que o bloco deve ser gravado em quatro fluxos (FORMATO_QUATRO_FLUXOS).
+ * @return long Tamanho do bloco compactado ou -1 se a saída não couber.
+ */
+long compactar_bloco_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade, int max_bits, int quatro_fluxos){
+    if(quatro_fluxos)
+        return compactar_quatro_fluxos(origem, tam_origem, destino, capacidade, max_bits);
+
+    unsigned long frequencia[TAM_ASCII] = {0};
+    histograma(origem, tam_origem, frequencia);
+
+    LEITOR leitor;
+    ESCRITOR escritor;
+    iniciar_leitor_memoria(&leitor, origem, tam_origem);
+    iniciar_escritor_memoria(&escritor, destino, capacidade);
+
+    if(codificar_canonico_leitor(&leitor, &escritor, frequencia, tam_origem, max_bits) < 0)
+        return -1;
+    return escritor.tamanho;
+}
+
+/**
+ * @brief Descompacta um bloco gravado por compactar_bloco_memoria, em um ou em quatro fluxos.
+ *
+ * @param origem Bloco compactado.
+ * @param tam_compactado Tamanho do bloco compactado.
+ * @param destino Região de saída.
+ * @param tam_original Tamanho original esperado do bloco.
+ * @return int 1 em caso de sucesso ou 0 se o bloco for inválido.
+ */
+int descompactar_bloco_memoria(const unsigned char *origem, size_t tam_compactado, unsigned char *destino, size_t tam_original){
+    if(tam_compactado >= 3 && origem[2] == FORMATO_QUATRO_FLUXOS)
+        return descompactar_quatro_fluxos(origem, tam_compactado, destino, tam_original);
+    if(tam_compactado < 3 || memcmp(origem, ASSINATURA, 2) != 0 || origem[2] != FORMATO_CANONICO)
+        return 0;
+
+    LEITOR leitor;
+    ESCRITOR escritor;
+    iniciar_leitor_memoria(&leitor, origem + 3, tam_compactado - 3);
+    iniciar_escritor_memoria(&escritor, destino, tam_original);
+
+    return decodificar_canonico_leitor(&leitor, &escritor, tam_compactado) && escritor.tamanho == tam_original;
+}
+
+/**
+ * @brief Retorna o maior tamanho possível da saída de compactar_memoria.
+ *
+ * @param tam_original Tamanho dos dados originais.
+ * @return size_t Capacidade que garante que a compactação cabe na saída.
+ */
+size_t limite_compactado(size_t tam_original){
+    size_t blocos = (tam_original + TAM_BLOCO_HUFFMAN - 1) / TAM_BLOCO_HUFFMAN;
+    return tam_original + blocos * (8 + limite_bloco_canonico(0)) + 12;
+}
+
+/**
+ * @brief Compacta uma região de memória em outra, no formato em blocos.
+ *
+ * @param origem Dados originais.
+ * @param tam_origem Quantidade de bytes originais.
+ * @param destino Região de saída.
+ * @param capacidade Tamanho da região de saída.
+ * @param max_bits Tamanho máximo dos códigos (0 para não limitar).
+ * @param quatro_fluxos Indica que os blocos devem ser gravados em quatro fluxos.
+ * @return long long Quantidade de bytes gravados ou -1 se a saída não couber.
+ */
+long long compactar_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade, int max_bits, int quatro_fluxos){
+    if(capacidade < 12) return -1;
+
+    memcpy(destino, ASSINATURA, 2);
+    destino[2] = FORMATO_BLOCOS;
+    destino[3] = max_bits;
+    gravar_u32(destino + 4, TAM_BLOCO_HUFFMAN);
+    size_t posicao = 8;
+
+    while(tam_origem > 0){
+        size_t tam_bloco = tam_origem < TAM_BLOCO_HUFFMAN ? tam_origem : TAM_BLOCO_HUFFMAN;
+        if(capacidade - posicao < 12) return -1;
+
+        // Reserva 4 bytes para o marcador de fim depois do bloco
+        long tam_compactado = compactar_bloco_memoria(origem, tam_bloco, destino + posicao + 8, capacidade - posicao - 12, max_bits, quatro_fluxos);
+        if(tam_compactado < 0) return -1;
+
+        gravar_u32(destino + posicao, tam_bloco);
+        gravar_u32(destino + posicao + 4, tam_compactado);
+        posicao += 8 + tam_compactado;
+        origem += tam_bloco;
+        tam_origem -= tam_bloco;
+    }
+
+    gravar_u32(destino + posicao, 0);
+    return posicao + 4;
+}
+
+/**
+ * @brief Percorre o índice dos blocos e retorna o tamanho dos dados originais.
+ *
+ * @param origem Dados compactados.
+ * @param tam_origem Tamanho dos dados compactados.
+ * @return long long Tamanho dos dados originais ou -1 se os dados forem inválidos.
+ */
+long long tamanho_descompactado(const unsigned char *origem, size_t tam_origem){
+    if(tam_origem < 8 || memcmp(origem, ASSINATURA, 2) != 0 || origem[2] != FORMATO_BLOCOS)
+        return -1;
+
+    unsigned long tam_bloco = extrair_u32(origem + 4);
+    if(tam_bloco == 0 || tam_bloco > MAX_BLOCO_HUFFMAN)
+        return -1;
+
+    size_t posicao = 8;
+    long long total = 0;
+    for(;;){
+        if(tam_origem - posicao < 4) return -1;
+        unsigned long tam_original = extrair_u32(origem + posicao);
+        if(tam_original == 0) return total;
+        if(tam_origem - posicao < 8) return -1;
+
+        unsigned long tam_compactado = extrair_u32(origem + posicao + 4);
+        if(tam_original > tam_bloco || tam_compactado > tam_origem - posicao - 8)
+            return -1;
+
+        total += tam_original;
+        posicao += 8 + tam_compactado;
+    }
+}
+
+/**
+ * @brief Descompacta uma região de memória gravada no formato em blocos.
+ *
+ * @param origem Dados compactados.
+ * @param tam_origem Tamanho dos dados compactados.
+ * @param destino Região de saída.
+ * @param capacidade Tamanho da região de saída (tamanho_descompactado informa o necessário).
+ * @return long long Quantidade de bytes descompactados ou -1 se os dados forem inválidos ou não couberem.
+ */
+long long descompactar_memoria(const unsigned char *origem, size_t tam_origem, unsigned char *destino, size_t capacidade){
+    if(tamanho_descompactado(origem, tam_origem) < 0)
+        return -1;
+
+    size_t posicao = 8, total = 0;
+    for(;;){
+        unsigned long tam_original = extrair_u32(origem + posicao);
+        if(tam_original == 0) return total;
+
+        unsigned long tam_compactado = extrair_u32(origem + posicao + 4);
+        if(tam_original > capacidade - total ||
+           !descompactar_bloco_memoria(origem + posicao + 8, tam_compactado, destino + total, tam_original))
+            return -1;
+
+        total += tam_original;
+        posicao += 8 + tam_compactado;
+    }
+}
+
+#endif
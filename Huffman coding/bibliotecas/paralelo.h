@@ -0,0 +1,271 @@
+/**
+ * @file paralelo.h
+ * @brief Pool de threads (POSIX threads) usado pelos modos paralelos do compressor.
+ *
+ * As tarefas são funções com um argumento, colocadas em uma fila circular; as threads do pool
+ * retiram as tarefas da fila até o pool ser encerrado. No Windows, compile com a winpthreads do MinGW.
+ * Também contém o histograma paralelo, que divide entradas grandes entre as threads do pool.
+ */
+
+#ifndef PARALELO_H
+#define PARALELO_H
+
+#include "histograma.h"
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/**
+ * @struct TAREFA
+ * @brief Tarefa do pool: uma função e o argumento com que ela será chamada.
+ */
+typedef struct{
+    void (*funcao)(void *);
+    void *argumento;
+}TAREFA;
+
+/**
+ * @struct POOL
+ * @brief Pool de threads com uma fila circular de tarefas.
+ *
+ * - threads: threads trabalhadoras.
+ * - n_threads: quantidade de threads.
+ * - fila: tarefas aguardando execução.
+ * - capacidade: tamanho máximo da fila.
+ * - inicio: posição da próxima tarefa a ser retirada.
+ * - quantidade: tarefas na fila.
+ * - pendentes: tarefas enviadas que ainda não terminaram.
+ * - encerrar: indica que as threads devem sair.
+ */
+typedef struct{
+    pthread_t *threads;
+    int n_threads;
+    TAREFA *fila;
+    int capacidade;
+    int inicio;
+    int quantidade;
+    int pendentes;
+    int encerrar;
+    pthread_mutex_t trava;
+    pthread_cond_t tem_tarefa;
+    pthread_cond_t tem_espaco;
+    pthread_cond_t terminou;
+}POOL;
+
+/**
+ * @brief Retorna a quantidade de processadores disponíveis.
+ *
+ * @return int Quantidade de processadores (pelo menos 1).
+ */
+int numero_processadores(){
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+/**
+ * @brief Laço de cada thread do pool: retira e executa tarefas até o pool ser encerrado.
+ *
+ * @param argumento Ponteiro para o pool.
+ * @return void* Sempre NULL.
+ */
+void *trabalhar_pool(void *argumento){
+    POOL *pool = argumento;
+
+    for(;;){
+        pthread_mutex_lock(&pool->trava);
+        while(pool->quantidade == 0 && !pool->encerrar)
+            pthread_cond_wait(&pool->tem_tarefa, &pool->trava);
+
+        if(pool->quantidade == 0){
+            pthread_mutex_unlock(&pool->trava);
+            return NULL;
+        }
+
+        TAREFA tarefa = pool->fila[pool->inicio];
+        pool->inicio = (pool->inicio + 1) % pool->capacidade;
+        pool->quantidade--;
+        pthread_cond_signal(&pool->tem_espaco);
+        pthread_mutex_unlock(&pool->trava);
+
+        tarefa.funcao(tarefa.argumento);
+
+        pthread_mutex_lock(&pool->trava);
+        if(--pool->pendentes == 0)
+            pthread_cond_broadcast(&pool->terminou);
+        pthread_mutex_unlock(&pool->trava);
+    }
+}
+
+/**
+ * @brief Cria as threads do pool.
+ *
+ * @param pool Ponteiro para o pool.
+ * @param n_threads Quantidade de threads (0 usa a quantidade de processadores).
+ * @param capacidade Tamanho máximo da fila de tarefas.
+ * @return int 1 em caso de sucesso ou 0 se não foi possível criar o pool.
+ */
+int iniciar_pool(POOL *pool, int n_threads, int capacidade){
+    if(n_threads <= 0) n_threads = numero_processadores();
+    if(capacidade <= 0) capacidade = n_threads;
+
+    pool->threads = malloc(n_threads * sizeof(pthread_t));
+    pool->fila = malloc(capacidade * sizeof(TAREFA));
+    pool->n_threads = 0;
+    pool->capacidade = capacidade;
+    pool->inicio = pool->quantidade = pool->pendentes = pool->encerrar = 0;
+
+    if(!pool->threads || !pool->fila){
+        free(pool->threads);
+        free(pool->fila);
+        return 0;
+    }
+
+    pthread_mutex_init(&pool->trava, NULL);
+    pthread_cond_init(&pool->tem_tarefa, NULL);
+    pthread_cond_init(&pool->tem_espaco, NULL);
+    pthread_cond_init(&pool->terminou, NULL);
+
+    for(int i = 0; i < n_threads; i++){
+        if(pthread_create(&pool->threads[i], NULL, trabalhar_pool, pool) != 0)
+            break;
+        pool->n_threads++;
+    }
+
+    return pool->n_threads > 0;
+}
+
+/**
+ * @brief Envia uma tarefa ao pool, esperando enquanto a fila estiver cheia.
+ *
+ * @param pool Ponteiro para o pool.
+ * @param funcao Função a ser executada.
+ * @param argumento Argumento da função.
+ */
+void enviar_tarefa(POOL *pool, void (*funcao)(void *), void *argumento){
+    pthread_mutex_lock(&pool->trava);
+    while(pool->quantidade == pool->capacidade)
+        pthread_cond_wait(&pool->tem_espaco, &pool->trava);
+
+    int fim = (pool->inicio + pool->quantidade) % pool->capacidade;
+    pool->fila[fim].funcao = funcao;
+    pool->fila[fim].argumento = argumento;
+    pool->quantidade++;
+    pool->pendentes++;
+
+    pthread_cond_signal(&pool->tem_tarefa);
+    pthread_mutex_unlock(&pool->trava);
+}
+
+/**
+ * @brief Espera todas as tarefas enviadas terminarem.
+ *
+ * @param pool Ponteiro para o pool.
+ */
+void esperar_pool(POOL *pool){
+    pthread_mutex_lock(&pool->trava);
+    while(pool->pendentes > 0)
+        pthread_cond_wait(&pool->terminou, &pool->trava);
+    pthread_mutex_unlock(&pool->trava);
+}
+
+/**
+ * @brief Termina as tarefas pendentes, encerra as threads e libera o pool.
+ *
+ * @param pool Ponteiro para o pool.
+ */
+void encerrar_pool(POOL *pool){
+    pthread_mutex_lock(&pool->trava);
+    pool->encerrar = 1;
+    pthread_cond_broadcast(&pool->tem_tarefa);
+    pthread_mutex_unlock(&pool->trava);
+
+    for(int i = 0; i < pool->n_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_mutex_destroy(&pool->trava);
+    pthread_cond_destroy(&pool->tem_tarefa);
+    pthread_cond_destroy(&pool->tem_espaco);
+    pthread_cond_destroy(&pool->terminou);
+    free(pool->threads);
+    free(pool->fila);
+}
+
+/**
+ * @def MIN_HISTOGRAMA_PARALELO
+ * @brief Tamanho mínimo, em bytes, de cada parte entregue a uma thread no histograma paralelo (8 MiB).
+ */
+#define MIN_HISTOGRAMA_PARALELO (1UL << 23)
+
+/**
+ * @struct PARTE_HISTOGRAMA
+ * @brief Parte dos dados contada por uma thread do histograma paralelo.
+ */
+typedef struct{
+    const unsigned char *dados;
+    size_t tamanho;
+    unsigned long frequencia[TAM_ASCII];
+}PARTE_HISTOGRAMA;
+
+/**
+ * @brief Tarefa do pool que conta uma parte dos dados.
+ *
+ * @param argumento Ponteiro para a PARTE_HISTOGRAMA.
+ */
+void contar_parte(void *argumento){
+    PARTE_HISTOGRAMA *parte = argumento;
+    memset(parte->frequencia, 0, sizeof(parte->frequencia));
+    histograma(parte->dados, parte->tamanho, parte->frequencia);
+}
+
+/**
+ * @brief Soma ao vetor de frequência a quantidade de cada byte, dividindo entradas grandes entre threads.
+ *
+ * Entradas menores que duas partes de MIN_HISTOGRAMA_PARALELO bytes (ou com uma só thread) são
+ * contadas diretamente na thread atual.
+ *
+ * @param dados Bytes a serem contados.
+ * @param tamanho Quantidade de bytes.
+ * @param frequencia Vetor com 256 posições, que é acumulado (não é zerado).
+ * @param n_threads Quantidade máxima de threads (0 usa a quantidade de processadores).
+ */
+void histograma_paralelo(const unsigned char *dados, size_t tamanho, unsigned long *frequencia, int n_threads){
+    if(n_threads <= 0) n_threads = numero_processadores();
+
+    size_t partes = tamanho / MIN_HISTOGRAMA_PARALELO;
+    if(partes > (size_t)n_threads) partes = n_threads;
+
+    POOL pool;
+    PARTE_HISTOGRAMA *vetor = partes >= 2 ? malloc(partes * sizeof(PARTE_HISTOGRAMA)) : NULL;
+    if(!vetor || !iniciar_pool(&pool, partes, partes)){
+        free(vetor);
+        histograma(dados, tamanho, frequencia);
+        return;
+    }
+
+    size_t passo = tamanho / partes;
+    for(size_t i = 0; i < partes; i++){
+        vetor[i].dados = dados + i * passo;
+        vetor[i].tamanho = (i == partes - 1) ? tamanho - i * passo : passo;
+        enviar_tarefa(&pool, contar_parte, &vetor[i]);
+    }
+    esperar_pool(&pool);
+    encerrar_pool(&pool);
+
+    for(size_t i = 0; i < partes; i++)
+        for(int s = 0; s < TAM_ASCII; s++)
+            frequencia[s] += vetor[i].frequencia[s];
+
+    free(vetor);
+}
+
+#endif
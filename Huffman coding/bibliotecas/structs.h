@@ -3,9 +3,21 @@
  * @brief Definições de estruturas e constantes utilizadas no algoritmo de compressão Huffman.
  */
 
+#ifndef STRUCTS_H
+#define STRUCTS_H
+
+// Expõe as funções POSIX (fileno, fseeko, mmap...) mesmo quando o compilador usa -std=c11 estrito.
+// Este é o primeiro cabeçalho incluído por todas as bibliotecas, antes de qualquer cabeçalho do sistema.
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+// off_t de 64 bits também em sistemas de 32 bits: o índice dos blocos usa fseeko/ftello além de 2 GiB
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
+
 #include <stdio.h>      
 #include <stdlib.h>    
-#include <windows.h>    /**< Para suporte a acentuação no Windows (SetConsoleOutputCP) */
 #include <string.h> 
 
 /** 
@@ -20,32 +32,256 @@
  */
 #define TAM_ASCII 256
 
+/** 
+ * @def TAM_BLOCO_IO
+ * @brief Tamanho padrão, em bytes, dos blocos usados na leitura e escrita bufferizada (1 MiB).
+ */
+#define TAM_BLOCO_IO (1 << 20)
+
+/** 
+ * @def ASSINATURA
+ * @brief Assinatura gravada no início dos arquivos nos formatos versionados.
+ */
+#define ASSINATURA "HF"
+
+/** 
+ * @def FORMATO_CANONICO
+ * @brief Versão do formato com códigos canônicos (cabeçalho só com os tamanhos dos códigos).
+ */
+#define FORMATO_CANONICO 1
+
+/** 
+ * @def FORMATO_BLOCOS
+ * @brief Versão do formato em blocos canônicos independentes, processados em paralelo.
+ */
+#define FORMATO_BLOCOS 2
+
+/** 
+ * @def FORMATO_ADAPTATIVO
+ * @brief Versão do formato com Huffman adaptativo (a árvore é atualizada a cada caractere, sem cabeçalho).
+ */
+#define FORMATO_ADAPTATIVO 3
+
+/** 
+ * @def FORMATO_DICIONARIO
+ * @brief Versão dos arquivos de dicionário: tabela de Huffman treinada, compartilhada por várias mensagens.
+ */
+#define FORMATO_DICIONARIO 4
+
+/** 
+ * @def FORMATO_COM_DICIONARIO
+ * @brief Versão das mensagens compactadas com um dicionário (sem árvore nem tabela no cabeçalho).
+ */
+#define FORMATO_COM_DICIONARIO 5
+
+/** 
+ * @def FORMATO_CONTEXTO
+ * @brief Versão do formato de ordem 1, com uma tabela de códigos por grupo de contextos (byte anterior).
+ */
+#define FORMATO_CONTEXTO 6
+
+/** 
+ * @def FORMATO_QUATRO_FLUXOS
+ * @brief Versão dos blocos canônicos divididos em quatro fluxos de bits, decodificados intercalados.
+ */
+#define FORMATO_QUATRO_FLUXOS 7
+
+/** 
+ * @def FORMATO_LARGO
+ * @brief Versão do formato com alfabeto de 16 bits e campos largos no cabeçalho.
+ */
+#define FORMATO_LARGO 8
+
 /**
  * @struct NOHUFF
  * @brief Estrutura que representa um nó da árvore de Huffman.
  *
  * Cada nó armazena:
- * - Um ponteiro genérico para o caractere ou valor.
+ * - O caractere, guardado no próprio nó ('*' nos nós internos).
  * - A frequência de ocorrência desse caractere.
- * - Ponteiros para o próximo nó (caso em lista).
  * - Ponteiros para os nós esquerdo e direito na árvore de Huffman.
  */
 typedef struct nohuff {
-    void *caracter;                       
-    int frequencia;                       
-    struct nohuff *prox;               
+    unsigned char caracter;                       
+    unsigned long frequencia;                       
     struct nohuff *esquerda, *direita;
 } NOHUFF;
 
+/** 
+ * @def MAX_NOS_ARVORE
+ * @brief Quantidade máxima de nós de uma árvore de Huffman com TAM_ASCII folhas.
+ */
+#define MAX_NOS_ARVORE (2 * TAM_ASCII - 1)
+
+/**
+ * @struct ARENA_NOS
+ * @brief Área com espaço para todos os nós de uma árvore, entregues em sequência.
+ *
+ * Os nós não são alocados nem liberados um a um: a árvore inteira é descartada de uma vez
+ * zerando a quantidade de nós usados, e a mesma arena pode ser reaproveitada na árvore seguinte.
+ * - nos: espaço dos nós.
+ * - tamanho: quantidade de nós já entregues.
+ */
+typedef struct{
+    NOHUFF nos[MAX_NOS_ARVORE];
+    int tamanho;
+}ARENA_NOS;
+
 /**
  * @struct HEAP
- * @brief Estrutura que representa uma heap máxima para montagem da árvore de Huffman.
+ * @brief Estrutura que representa uma heap mínima para montagem da árvore de Huffman.
  *
  * A heap é implementada como um vetor de ponteiros para nós de Huffman, controlado pelos campos:
  * - tamanho: quantidade atual de elementos.
  * - capacidade: capacidade máxima permitida.
  */
 typedef struct{
-    NOHUFF *inicio; 
+    NOHUFF **dados;
     int tamanho;
-}LISTA;
+    int capacidade;
+}HEAP;
+
+/**
+ * @struct LEITOR
+ * @brief Leitor bufferizado que busca o arquivo em blocos grandes com um único fread.
+ *
+ * Sem arquivo (arquivo == NULL) o leitor percorre diretamente uma região de memória, que é
+ * entregue inteira na primeira recarga.
+ *
+ * - arquivo: arquivo de origem dos dados (NULL para memória).
+ * - dados: bloco atualmente carregado na memória.
+ * - capacidade: tamanho máximo do bloco.
+ * - tamanho: quantidade de bytes válidos no bloco.
+ * - posicao: próximo byte a ser consumido dentro do bloco.
+ * - esgotado: indica que a região de memória já foi entregue.
+ */
+typedef struct{
+    FILE *arquivo;
+    unsigned char *dados;
+    size_t capacidade;
+    size_t tamanho;
+    size_t posicao;
+    int esgotado;
+}LEITOR;
+
+/**
+ * @struct ESCRITOR
+ * @brief Escritor bufferizado que acumula bytes e os grava em blocos com um único fwrite.
+ *
+ * Sem arquivo (arquivo == NULL) o próprio bloco é o destino final dos dados: ele cresce quando
+ * pertence ao escritor ou marca erro quando a capacidade fornecida pelo chamador acaba.
+ *
+ * - arquivo: arquivo de destino dos dados (NULL para memória).
+ * - dados: bloco que está sendo preenchido.
+ * - capacidade: tamanho máximo do bloco.
+ * - tamanho: quantidade de bytes pendentes no bloco.
+ * - crescer: indica que o bloco de memória pertence ao escritor e pode ser realocado.
+ * - erro: indica que a escrita falhou ou que a capacidade de memória não bastou.
+ */
+typedef struct{
+    FILE *arquivo;
+    unsigned char *dados;
+    size_t capacidade;
+    size_t tamanho;
+    int crescer;
+    int erro;
+}ESCRITOR;
+
+/**
+ * @struct LEITOR_BITS
+ * @brief Leitor de bits sobre um LEITOR, com um acumulador de 64 bits alinhado à esquerda.
+ *
+ * - leitor: leitor bufferizado de onde os bytes são retirados.
+ * - acumulador: bits ainda não consumidos, o próximo bit fica no bit mais significativo.
+ * - quantidade: quantidade de bits válidos no acumulador.
+ * - fim: indica que o leitor já chegou ao fim dos dados.
+ */
+typedef struct{
+    LEITOR *leitor;
+    unsigned long long acumulador;
+    int quantidade;
+    int fim;
+}LEITOR_BITS;
+
+/**
+ * @struct ESCRITOR_BITS
+ * @brief Escritor de bits sobre um ESCRITOR, que acumula até 64 bits e os grava como uma palavra inteira.
+ *
+ * - escritor: escritor bufferizado que recebe os bytes.
+ * - acumulador: bits pendentes, alinhados à direita (o último bit escrito é o menos significativo).
+ * - quantidade: quantidade de bits pendentes no acumulador (sempre menor que 64).
+ */
+typedef struct{
+    ESCRITOR *escritor;
+    unsigned long long acumulador;
+    int quantidade;
+}ESCRITOR_BITS;
+
+/**
+ * @struct CODIGO
+ * @brief Código de Huffman de um símbolo guardado como inteiro.
+ *
+ * - bits: os bits do código, alinhados à direita (o último bit do caminho é o bit menos significativo).
+ * - tamanho: quantidade de bits do código (0 para símbolos que não aparecem).
+ */
+typedef struct{
+    unsigned long long bits;
+    unsigned char tamanho;
+}CODIGO;
+
+/**
+ * @def MAX_BITS_CODIGO
+ * @brief Maior tamanho de código representável em um CODIGO.
+ */
+#define MAX_BITS_CODIGO 64
+
+/**
+ * @def BITS_TABELA
+ * @brief Quantidade de bits resolvida por consulta na tabela principal de decodificação.
+ */
+#define BITS_TABELA 11
+
+/**
+ * @def BITS_SUBTABELA
+ * @brief Quantidade máxima de bits resolvida por consulta nas tabelas secundárias (códigos longos).
+ */
+#define BITS_SUBTABELA 8
+
+/**
+ * @struct ENTRADA_TABELA
+ * @brief Entrada da tabela de decodificação.
+ *
+ * Quando quantidade > 0 a entrada contém um ou dois símbolos completos:
+ * - simbolos: os símbolos decodificados, na ordem em que aparecem.
+ * - bits: total de bits consumidos por todos os símbolos da entrada.
+ * - bits_primeiro: bits consumidos apenas pelo primeiro símbolo.
+ *
+ * Quando quantidade == 0 a entrada aponta para uma tabela secundária:
+ * - subtabela: índice da primeira entrada da tabela secundária.
+ * - bits: quantidade de bits usada para indexar a tabela secundária (0 indica código inválido).
+ */
+typedef struct{
+    unsigned short simbolos[2];
+    unsigned char quantidade;
+    unsigned char bits;
+    unsigned char bits_primeiro;
+    unsigned int subtabela;
+}ENTRADA_TABELA;
+
+/**
+ * @struct TABELA_DECODIFICACAO
+ * @brief Tabela de decodificação em vários níveis, guardada em um único vetor.
+ *
+ * - entradas: vetor com a tabela principal (nas primeiras posições) e todas as secundárias.
+ * - tamanho: quantidade de entradas em uso.
+ * - capacidade: quantidade de entradas alocadas.
+ * - bits_raiz: bits usados para indexar a tabela principal.
+ */
+typedef struct{
+    ENTRADA_TABELA *entradas;
+    size_t tamanho;
+    size_t capacidade;
+    int bits_raiz;
+}TABELA_DECODIFICACAO;
+
+#endif
@@ -0,0 +1,346 @@
+/**
+ * @file tabela_decodificacao.h
+ * @brief Decodificador de Huffman por tabela, que resolve vários bits por consulta.
+ *
+ * A tabela principal é indexada pelos próximos BITS_TABELA bits da entrada e devolve de uma vez
+ * um ou dois símbolos completos. Códigos maiores que a tabela principal continuam em tabelas
+ * secundárias de até BITS_SUBTABELA bits, encadeadas quantas vezes forem necessárias.
+ */
+
+#ifndef TABELA_DECODIFICACAO_H
+#define TABELA_DECODIFICACAO_H
+
+#include "buffer_io.h"
+
+/**
+ * @brief Reserva entradas zeradas no fim do vetor da tabela.
+ *
+ * @param tabela Ponteiro para a tabela.
+ * @param quantidade Quantidade de entradas a reservar.
+ * @return long Índice da primeira entrada reservada ou -1 se faltar memória.
+ */
+long reservar_entradas(TABELA_DECODIFICACAO *tabela, size_t quantidade){
+    if(tabela->tamanho + quantidade > tabela->capacidade){
+        size_t nova = tabela->capacidade ? tabela->capacidade : 1024;
+        while(nova < tabela->tamanho + quantidade)
+            nova <<= 1;
+
+        ENTRADA_TABELA *novas = realloc(tabela->entradas, nova * sizeof(ENTRADA_TABELA));
+        if(!novas) return -1;
+
+        tabela->entradas = novas;
+        tabela->capacidade = nova;
+    }
+
+    long inicio = tabela->tamanho;
+    memset(tabela->entradas + inicio, 0, quantidade * sizeof(ENTRADA_TABELA));
+    tabela->tamanho += quantidade;
+    return inicio;
+}
+
+/**
+ * @brief Retorna o código alinhado à esquerda em 64 bits, usado para ordenar os símbolos por prefixo.
+ *
+ * @param codigo Ponteiro para o código.
+ * @return unsigned long long Código alinhado à esquerda.
+ */
+static inline unsigned long long codigo_alinhado(const CODIGO *codigo){
+    return codigo->bits << (MAX_BITS_CODIGO - codigo->tamanho);
+}
+
+/**
+ * @struct CODIGO_ORDENADO
+ * @brief Símbolo acompanhado do seu código alinhado à esquerda, usado como chave da ordenação.
+ */
+typedef struct{
+    unsigned long long chave;
+    int simbolo;
+}CODIGO_ORDENADO;
+
+/**
+ * @brief Compara dois símbolos pelo código alinhado e, no empate, pelo símbolo (usada no qsort).
+ */
+int comparar_codigos_ordenados(const void *a, const void *b){
+    const CODIGO_ORDENADO *x = a, *y = b;
+    if(x->chave != y->chave) return x->chave < y->chave ? -1 : 1;
+    return x->simbolo - y->simbolo;
+}
+
+/**
+ * @brief Ordena os símbolos pelos seus códigos alinhados à esquerda, em O(n log n).
+ *
+ * Assim, símbolos que compartilham um prefixo ficam contíguos no vetor. Com alfabetos de 16 bits
+ * (largo.h) a ordenação por inserção, quadrática, dominaria a construção da tabela.
+ *
+ * @param simbolos Vetor de símbolos.
+ * @param quantidade Quantidade de símbolos.
+ * @param codigos Códigos indexados por símbolo.
+ * @return int 1 em caso de sucesso ou 0 se faltar memória.
+ */
+int ordenar_por_codigo(int *simbolos, int quantidade, const CODIGO *codigos){
+    CODIGO_ORDENADO *itens = malloc(quantidade * sizeof(CODIGO_ORDENADO));
+    if(!itens) return 0;
+
+    for(int i = 0; i < quantidade; i++){
+        itens[i].chave = codigo_alinhado(&codigos[simbolos[i]]);
+        itens[i].simbolo = simbolos[i];
+    }
+    qsort(itens, quantidade, sizeof(CODIGO_ORDENADO), comparar_codigos_ordenados);
+
+    for(int i = 0; i < quantidade; i++)
+        simbolos[i] = itens[i].simbolo;
+
+    free(itens);
+    return 1;
+}
+
+/**
+ * @brief Preenche um nível da tabela com os símbolos cujos códigos começam pelo mesmo prefixo.
+ *
+ * @param tabela Ponteiro para a tabela.
+ * @param base Índice da primeira entrada do nível.
+ * @param bits_nivel Quantidade de bits que indexa o nível.
+ * @param consumidos Bits do prefixo já resolvidos pelos níveis anteriores.
+ * @param codigos Códigos indexados por símbolo.
+ * @param simbolos Símbolos ordenados por código.
+ * @param inicio Primeiro símbolo do intervalo que pertence ao nível.
+ * @param fim Posição seguinte ao último símbolo do intervalo.
+ * @return int 1 em caso de sucesso ou 0 se faltar memória.
+ */
+int preencher_nivel(TABELA_DECODIFICACAO *tabela, size_t base, int bits_nivel, int consumidos, const CODIGO *codigos, const int *simbolos, int inicio, int fim){
+    int i = inicio;
+
+    while(i < fim){
+        const CODIGO *codigo = &codigos[simbolos[i]];
+        int resto = codigo->tamanho - consumidos;
+        unsigned long long sufixo = codigo->bits & ((resto < 64) ? ((1ULL << resto) - 1) : ~0ULL);
+
+        if(resto <= bits_nivel){
+            size_t primeiro = base + (sufixo << (bits_nivel - resto));
+            size_t repeticoes = (size_t)1 << (bits_nivel - resto);
+
+            for(size_t k = 0; k < repeticoes; k++){
+                ENTRADA_TABELA *entrada = &tabela->entradas[primeiro + k];
+                entrada->simbolos[0] = simbolos[i];
+                entrada->quantidade = 1;
+                entrada->bits = resto;
+                entrada->bits_primeiro = resto;
+            }
+            i++;
+            continue;
+        }
+
+        unsigned long long topo = sufixo >> (resto - bits_nivel);
+        int maior_resto = resto;
+        int j = i + 1;
+
+        while(j < fim){
+            const CODIGO *proximo = &codigos[simbolos[j]];
+            int resto_proximo = proximo->tamanho - consumidos;
+            if(resto_proximo <= bits_nivel || ((proximo->bits >> (resto_proximo - bits_nivel)) & ((1ULL << bits_nivel) - 1)) != topo)
+                break;
+            if(resto_proximo > maior_resto)
+                maior_resto = resto_proximo;
+            j++;
+        }
+
+        int bits_sub = maior_resto - bits_nivel;
+        if(bits_sub > BITS_SUBTABELA)
+            bits_sub = BITS_SUBTABELA;
+
+        long sub = reservar_entradas(tabela, (size_t)1 << bits_sub);
+        if(sub < 0) return 0;
+
+        ENTRADA_TABELA *ligacao = &tabela->entradas[base + topo];
+        ligacao->quantidade = 0;
+        ligacao->bits = bits_sub;
+        ligacao->subtabela = sub;
+
+        if(!preencher_nivel(tabela, sub, bits_sub, consumidos + bits_nivel, codigos, simbolos, i, j))
+            return 0;
+        i = j;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Junta, em cada entrada da tabela principal, um segundo símbolo que caiba nos bits que sobraram.
+ *
+ * @param tabela Ponteiro para a tabela.
+ */
+void combinar_pares(TABELA_DECODIFICACAO *tabela){
+    int bits_raiz = tabela->bits_raiz;
+    size_t mascara = ((size_t)1 << bits_raiz) - 1;
+
+    for(size_t indice = 0; indice <= mascara; indice++){
+        ENTRADA_TABELA *entrada = &tabela->entradas[indice];
+        if(entrada->quantidade != 1 || entrada->bits_primeiro >= bits_raiz)
+            continue;
+
+        const ENTRADA_TABELA *segunda = &tabela->entradas[(indice << entrada->bits_primeiro) & mascara];
+        if(segunda->quantidade == 0 || segunda->bits_primeiro > bits_raiz - entrada->bits_primeiro)
+            continue;
+
+        entrada->simbolos[1] = segunda->simbolos[0];
+        entrada->bits = entrada->bits_primeiro + segunda->bits_primeiro;
+        entrada->quantidade = 2;
+    }
+}
+
+/**
+ * @brief Constrói a tabela de decodificação a partir dos códigos de cada símbolo.
+ *
+ * @param tabela Ponteiro para a tabela (será inicializada).
+ * @param codigos Códigos indexados por símbolo (tamanho 0 para símbolos ausentes).
+ * @param n_simbolos Quantidade de símbolos do alfabeto.
+ * @return int 1 em caso de sucesso ou 0 se faltar memória ou se não houver códigos.
+ */
+int construir_tabela(TABELA_DECODIFICACAO *tabela, const CODIGO *codigos, int n_simbolos){
+    tabela->entradas = NULL;
+    tabela->tamanho = tabela->capacidade = 0;
+    tabela->bits_raiz = 0;
+
+    int *simbolos = malloc(n_simbolos * sizeof(int));
+    if(!simbolos) return 0;
+
+    int quantidade = 0, maior = 0;
+    for(int i = 0; i < n_simbolos; i++){
+        if(codigos[i].tamanho > 0){
+            simbolos[quantidade++] = i;
+            if(codigos[i].tamanho > maior)
+                maior = codigos[i].tamanho;
+        }
+    }
+
+    if(quantidade == 0){
+        free(simbolos);
+        return 0;
+    }
+
+    tabela->bits_raiz = maior < BITS_TABELA ? maior : BITS_TABELA;
+    int ok = ordenar_por_codigo(simbolos, quantidade, codigos) &&
+             reservar_entradas(tabela, (size_t)1 << tabela->bits_raiz) == 0 &&
+             preencher_nivel(tabela, 0, tabela->bits_raiz, 0, codigos, simbolos, 0, quantidade);
+
+    free(simbolos);
+    if(!ok){
+        free(tabela->entradas);
+        tabela->entradas = NULL;
+        return 0;
+    }
+
+    combinar_pares(tabela);
+    return 1;
+}
+
+/**
+ * @brief Decodifica um símbolo que não foi resolvido pela tabela principal, descendo pelas tabelas secundárias.
+ *
+ * @param tabela Ponteiro para a tabela.
+ * @param leitor_bits Leitor de bits posicionado depois dos bits da tabela principal.
+ * @param ligacao Entrada que aponta para a primeira tabela secundária.
+ * @param restante Ponteiro para a quantidade de bits válidos que ainda restam.
+ * @return int O símbolo decodificado ou -1 se o código for inválido.
+ */
+int decodificar_longo(const TABELA_DECODIFICACAO *tabela, LEITOR_BITS *leitor_bits, const ENTRADA_TABELA *ligacao, unsigned long long *restante){
+    while(ligacao->bits > 0){
+        completar_bits(leitor_bits);
+        const ENTRADA_TABELA *entrada = &tabela->entradas[ligacao->subtabela + espiar_bits(leitor_bits, ligacao->bits)];
+
+        if(entrada->quantidade > 0){
+            if(entrada->bits_primeiro > *restante) return -1;
+            consumir_bits(leitor_bits, entrada->bits_primeiro);
+            *restante -= entrada->bits_primeiro;
+            return entrada->simbolos[0];
+        }
+
+        if(ligacao->bits > *restante) return -1;
+        consumir_bits(leitor_bits, ligacao->bits);
+        *restante -= ligacao->bits;
+        ligacao = entrada;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Decodifica um único símbolo com a tabela, sem juntar pares.
+ *
+ * @param tabela Ponteiro para a tabela.
+ * @param leitor_bits Leitor de bits posicionado no início do código.
+ * @param restante Ponteiro para a quantidade de bits válidos que ainda restam.
+ * @return int O símbolo decodificado ou -1 se o código for inválido.
+ */
+static inline int decodificar_simbolo(const TABELA_DECODIFICACAO *tabela, LEITOR_BITS *leitor_bits, unsigned long long *restante){
+    completar_bits(leitor_bits);
+    const ENTRADA_TABELA *entrada = &tabela->entradas[espiar_bits(leitor_bits, tabela->bits_raiz)];
+
+    if(entrada->quantidade > 0){
+        if(entrada->bits_primeiro > *restante) return -1;
+        consumir_bits(leitor_bits, entrada->bits_primeiro);
+        *restante -= entrada->bits_primeiro;
+        return entrada->simbolos[0];
+    }
+
+    if(entrada->bits == 0 || (unsigned long long)tabela->bits_raiz > *restante) return -1;
+    consumir_bits(leitor_bits, tabela->bits_raiz);
+    *restante -= tabela->bits_raiz;
+    return decodificar_longo(tabela, leitor_bits, entrada, restante);
+}
+
+/**
+ * @brief Decodifica um fluxo de bits com a tabela e escreve os bytes resultantes.
+ *
+ * @param tabela Ponteiro para a tabela.
+ * @param leitor_bits Leitor de bits posicionado no início dos dados.
+ * @param total_bits Quantidade de bits válidos no fluxo (sem o lixo do último byte).
+ * @param escritor Escritor de saída.
+ * @return int 1 se todos os bits foram decodificados ou 0 se o fluxo for inválido ou acabar antes.
+ */
+int decodificar_com_tabela(const TABELA_DECODIFICACAO *tabela, LEITOR_BITS *leitor_bits, unsigned long long total_bits, ESCRITOR *escritor){
+    unsigned long long restante = total_bits;
+    int bits_raiz = tabela->bits_raiz;
+
+    while(restante > 0){
+        completar_bits(leitor_bits);
+        // Os dados acabaram antes do total prometido: o resto do acumulador seria só zeros
+        if(leitor_bits->fim && leitor_bits->quantidade <= 0) return 0;
+        const ENTRADA_TABELA *entrada = &tabela->entradas[espiar_bits(leitor_bits, bits_raiz)];
+
+        if(entrada->quantidade == 2 && entrada->bits <= restante){
+            escrever_byte(escritor, entrada->simbolos[0]);
+            escrever_byte(escritor, entrada->simbolos[1]);
+            consumir_bits(leitor_bits, entrada->bits);
+            restante -= entrada->bits;
+        }else if(entrada->quantidade > 0){
+            if(entrada->bits_primeiro > restante) return 0;
+            escrever_byte(escritor, entrada->simbolos[0]);
+            consumir_bits(leitor_bits, entrada->bits_primeiro);
+            restante -= entrada->bits_primeiro;
+        }else{
+            if(entrada->bits == 0 || (unsigned long long)bits_raiz > restante) return 0;
+            consumir_bits(leitor_bits, bits_raiz);
+            restante -= bits_raiz;
+
+            int simbolo = decodificar_longo(tabela, leitor_bits, entrada, &restante);
+            if(simbolo < 0) return 0;
+            escrever_byte(escritor, simbolo);
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Libera a memória da tabela de decodificação.
+ *
+ * @param tabela Ponteiro para a tabela.
+ */
+void liberar_tabela(TABELA_DECODIFICACAO *tabela){
+    free(tabela->entradas);
+    tabela->entradas = NULL;
+    tabela->tamanho = tabela->capacidade = 0;
+}
+
+#endif
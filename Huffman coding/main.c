@@ -1,4 +1,16 @@
 #include "bibliotecas/huffman.h"
+#include "bibliotecas/canonico.h"
+#include "bibliotecas/blocos.h"
+#include "bibliotecas/adaptativo.h"
+#include "bibliotecas/dicionario.h"
+#include "bibliotecas/contexto.h"
+#include "bibliotecas/largo.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 /**
  * @brief Compacta um arquivo usando o algoritmo de Huffman.
@@ -16,27 +28,49 @@ void compactar(char *caminho, char *nome_arquivo){
     unsigned long tam_arq = tamanho_arquivo(arquivo_entrada);
     printf("\n\tTAMANHO DO ARQUIVO ORIGINAL: %ld bytes\n", tam_arq);
 
-    unsigned long *frequencia = contar_frequencia(arquivo_entrada, tam_arq);
-
-    LISTA fila;
-    fila.inicio = NULL;
-    fila.tamanho = 0;
+    LEITOR leitor;
+    ARQUIVO_MAPEADO mapa;
+    if(!abrir_leitor_mapeado(&leitor, &mapa, arquivo_entrada, TAM_BLOCO_IO)){
+        printf("\n\tERRO: MEMORIA INSUFICIENTE.\n");
+        fclose(arquivo_entrada);
+        return;
+    }
 
-    preencher_fila(frequencia, &fila);
+    unsigned long *frequencia = contar_frequencia(&leitor, tam_arq);
+    HEAP heap;
+    if(!frequencia || !iniciar_heap(&heap, TAM_ASCII)){
+        printf("\n\tERRO: MEMORIA INSUFICIENTE.\n");
+        fechar_leitor_mapeado(&leitor, &mapa);
+        fclose(arquivo_entrada);
+        free(frequencia);
+        return;
+    }
 
-    NOHUFF *arvore = montar_arvore(&fila);
+    // Todos os nós saem da arena, que é descartada de uma vez no fim da função
+    ARENA_NOS arena;
+    iniciar_arena(&arena);
+    preencher_heap(frequencia, &heap, &arena);
 
-    unsigned int tam_max = altura_arvore(arvore) + 1;
-    unsigned char **dicionario = malloc(sizeof(unsigned char*) * TAM_ASCII);
+    NOHUFF *arvore = montar_arvore(&heap, &arena);
+    liberar_heap(&heap);
 
-    for(int i = 0; i < TAM_ASCII; i++)
-        dicionario[i] = calloc(tam_max, sizeof(unsigned char));
+    if(arvore && altura_arvore(arvore) > MAX_BITS_CODIGO){
+        printf("\n\tERRO: CODIGOS MAIORES QUE %d BITS.\n", MAX_BITS_CODIGO);
+        fechar_leitor_mapeado(&leitor, &mapa);
+        fclose(arquivo_entrada);
+        free(frequencia);
+        return;
+    }
 
-    gerar_dicionario(dicionario, arvore, "", tam_max);
+    CODIGO codigos[TAM_ASCII] = {0};
+    gerar_codigos(codigos, arvore, 0, 0);
     
     FILE *arquivo_saida = fopen(nome_arquivo, "wb");
     if(!arquivo_saida){
         printf("\n\tERRO AO CRIAR ARQUIVO SAIDA");
+        fechar_leitor_mapeado(&leitor, &mapa);
+        fclose(arquivo_entrada);
+        free(frequencia);
         return;
     }
 
@@ -45,17 +79,244 @@ void compactar(char *caminho, char *nome_arquivo){
     short tam_arvore = salvar_arvore(arvore, arquivo_saida);
     printf("\n\tTAMANHO ARVORE: %d", tam_arvore);
 
-    short tam_lixo = salvar_dados(arquivo_entrada, arquivo_saida, dicionario, tam_arq, tam_arvore);
+    short tam_lixo = salvar_dados(&leitor, arquivo_saida, codigos, tam_arq, TAM_BLOCO_IO);
+    if(tam_lixo < 0){
+        printf("\n\tERRO: MEMORIA INSUFICIENTE.\n");
+        fechar_leitor_mapeado(&leitor, &mapa);
+        fclose(arquivo_entrada);
+        fclose(arquivo_saida);
+        remove(nome_arquivo);
+        free(frequencia);
+        return;
+    }
     printf("\n\tTAMANHO LIXO: %d", tam_lixo);
 
     salvar_cabecalho(arquivo_saida, tam_lixo, tam_arvore);
 
+    fechar_leitor_mapeado(&leitor, &mapa);
+    fclose(arquivo_entrada);
     fclose(arquivo_saida);
-    liberar_arvore(arvore);
-    liberar_dicionario(dicionario);
     free(frequencia);
 }
 
+/**
+ * @brief Compacta um arquivo usando códigos de Huffman canônicos.
+ * 
+ * @param caminho Caminho do arquivo a ser compactado.
+ * @param nome_arquivo Nome para o arquivo compactado de saída.
+ * @param max_bits Tamanho máximo dos códigos (0 para não limitar).
+ */
+void compactar_canonico(char *caminho, char *nome_arquivo, int max_bits){
+    FILE *arquivo_entrada = fopen(caminho, "rb");
+    if(!arquivo_entrada){
+        printf("\n\tERRO AO ABRIR ARQUIVO ENTRADA.\n");
+        return;
+    }
+
+    unsigned long tam_arq = tamanho_arquivo(arquivo_entrada);
+    printf("\n\tTAMANHO DO ARQUIVO ORIGINAL: %ld bytes\n", tam_arq);
+
+    LEITOR leitor;
+    ARQUIVO_MAPEADO mapa;
+    if(!abrir_leitor_mapeado(&leitor, &mapa, arquivo_entrada, TAM_BLOCO_IO)){
+        printf("\n\tERRO: MEMORIA INSUFICIENTE.\n");
+        fclose(arquivo_entrada);
+        return;
+    }
+
+    unsigned long *frequencia = contar_frequencia(&leitor, tam_arq);
+    if(!frequencia){
+        printf("\n\tERRO: MEMORIA INSUFICIENTE.\n");
+        fechar_leitor_mapeado(&leitor, &mapa);
+        fclose(arquivo_entrada);
+        return;
+    }
+
+    if(max_bits > 0){
+        unsigned long long bits_livre, bits_limitado;
+        double custo = custo_limite(frequencia, max_bits, &bits_livre, &bits_limitado);
+
+        if(custo < 0){
+            printf("\n\tERRO: %d BITS NAO BASTAM PARA TODOS OS CARACTERES.\n", max_bits);
+            fechar_leitor_mapeado(&leitor, &mapa);
+            fclose(arquivo_entrada);
+            free(frequencia);
+            return;
+        }
+        printf("\n\tDADOS SEM LIMITE: %llu bits", bits_livre);
+        printf("\n\tDADOS COM LIMITE DE %d BITS: %llu bits (+%.4f%%)\n", max_bits, bits_limitado, custo);
+    }
+
+    FILE *arquivo_saida = fopen(nome_arquivo, "wb");
+    if(!arquivo_saida){
+        printf("\n\tERRO AO CRIAR ARQUIVO SAIDA");
+        fechar_leitor_mapeado(&leitor, &mapa);
+        fclose(arquivo_entrada);
+        free(frequencia);
+        return;
+    }
+
+    long tam_cabecalho = codificar_canonico(&leitor, arquivo_saida, frequencia, tam_arq, max_bits, TAM_BLOCO_IO);
+    if(tam_cabecalho < 0)
+        printf("\n\tERRO AO COMPACTAR O ARQUIVO.\n");
+    else
+        printf("\n\tTAMANHO CABECALHO: %ld", tam_cabecalho);
+
+    fechar_leitor_mapeado(&leitor, &mapa);
+    fclose(arquivo_entrada);
+    fclose(arquivo_saida);
+    free(frequencia);
+}
+
+/**
+ * @brief Compacta um arquivo no modo de ordem 1 (códigos que dependem do byte anterior).
+ * 
+ * @param caminho Caminho do arquivo a ser compactado.
+ * @param nome_arquivo Nome para o arquivo compactado de saída.
+ */
+void compactar_contexto(char *caminho, char *nome_arquivo){
+    FILE *arquivo_entrada = fopen(caminho, "rb");
+    if(!arquivo_entrada){
+        printf("\n\tERRO AO ABRIR ARQUIVO ENTRADA.\n");
+        return;
+    }
+
+    unsigned long tam_arq = tamanho_arquivo(arquivo_entrada);
+    printf("\n\tTAMANHO DO ARQUIVO ORIGINAL: %ld bytes\n", tam_arq);
+
+    LEITOR leitor;
+    ARQUIVO_MAPEADO mapa;
+    if(!abrir_leitor_mapeado(&leitor, &mapa, arquivo_entrada, TAM_BLOCO_IO)){
+        printf("\n\tERRO: MEMORIA INSUFICIENTE.\n");
+        fclose(arquivo_entrada);
+        return;
+    }
+
+    FILE *arquivo_saida = fopen(nome_arquivo, "wb");
+    if(!arquivo_saida){
+        printf("\n\tERRO AO CRIAR ARQUIVO SAIDA");
+        fechar_leitor_mapeado(&leitor, &mapa);
+        fclose(arquivo_entrada);
+        return;
+    }
+
+    int n_tabelas;
+    long tam_cabecalho = codificar_contexto(&leitor, arquivo_saida, tam_arq, TAM_BLOCO_IO, &n_tabelas);
+    if(tam_cabecalho < 0)
+        printf("\n\tERRO AO COMPACTAR O ARQUIVO.\n");
+    else
+        printf("\n\tTABELAS DE CONTEXTO: %d\n\tTAMANHO CABECALHO: %ld", n_tabelas, tam_cabecalho);
+
+    fechar_leitor_mapeado(&leitor, &mapa);
+    fclose(arquivo_entrada);
+    fclose(arquivo_saida);
+}
+
+/**
+ * @brief Compacta um arquivo no modo de 16 bits (cada par de bytes é um símbolo).
+ * 
+ * @param caminho Caminho do arquivo a ser compactado.
+ * @param nome_arquivo Nome para o arquivo compactado de saída.
+ */
+void compactar_largo(char *caminho, char *nome_arquivo){
+    FILE *arquivo_entrada = fopen(caminho, "rb");
+    if(!arquivo_entrada){
+        printf("\n\tERRO AO ABRIR ARQUIVO ENTRADA.\n");
+        return;
+    }
+
+    unsigned long tam_arq = tamanho_arquivo(arquivo_entrada);
+    printf("\n\tTAMANHO DO ARQUIVO ORIGINAL: %ld bytes\n", tam_arq);
+
+    LEITOR leitor;
+    ARQUIVO_MAPEADO mapa;
+    if(!abrir_leitor_mapeado(&leitor, &mapa, arquivo_entrada, TAM_BLOCO_IO)){
+        printf("\n\tERRO: MEMORIA INSUFICIENTE.\n");
+        fclose(arquivo_entrada);
+        return;
+    }
+
+    FILE *arquivo_saida = fopen(nome_arquivo, "wb");
+    if(!arquivo_saida){
+        printf("\n\tERRO AO CRIAR ARQUIVO SAIDA");
+        fechar_leitor_mapeado(&leitor, &mapa);
+        fclose(arquivo_entrada);
+        return;
+    }
+
+    long presentes;
+    long tam_cabecalho = codificar_largo(&leitor, arquivo_saida, tam_arq, TAM_BLOCO_IO, &presentes);
+    if(tam_cabecalho < 0)
+        printf("\n\tERRO AO COMPACTAR O ARQUIVO.\n");
+    else
+        printf("\n\tSIMBOLOS DISTINTOS: %ld\n\tTAMANHO CABECALHO: %ld", presentes, tam_cabecalho);
+
+    fechar_leitor_mapeado(&leitor, &mapa);
+    fclose(arquivo_entrada);
+    fclose(arquivo_saida);
+}
+
+/**
+ * @brief Compacta um arquivo em blocos independentes, processados em paralelo.
+ * 
+ * @param caminho Caminho do arquivo a ser compactado.
+ * @param nome_arquivo Nome para o arquivo compactado de saída.
+ * @param n_threads Quantidade de threads (0 usa a quantidade de processadores).
+ */
+void compactar_em_blocos(char *caminho, char *nome_arquivo, int n_threads){
+    FILE *arquivo_entrada = fopen(caminho, "rb");
+    if(!arquivo_entrada){
+        printf("\n\tERRO AO ABRIR ARQUIVO ENTRADA.\n");
+        return;
+    }
+
+    FILE *arquivo_saida = fopen(nome_arquivo, "wb");
+    if(!arquivo_saida){
+        printf("\n\tERRO AO CRIAR ARQUIVO SAIDA");
+        fclose(arquivo_entrada);
+        return;
+    }
+
+    long blocos = compactar_blocos(arquivo_entrada, arquivo_saida, TAM_BLOCO_HUFFMAN, 0, n_threads, 1, 0);
+    if(blocos < 0)
+        printf("\n\tERRO AO COMPACTAR O ARQUIVO.\n");
+    else
+        printf("\n\tBLOCOS COMPACTADOS: %ld", blocos);
+
+    fclose(arquivo_entrada);
+    fclose(arquivo_saida);
+}
+
+/**
+ * @brief Compacta um arquivo com Huffman adaptativo, em uma única passada.
+ * 
+ * @param caminho Caminho do arquivo a ser compactado.
+ * @param nome_arquivo Nome para o arquivo compactado de saída.
+ */
+void compactar_adaptativo(char *caminho, char *nome_arquivo){
+    FILE *arquivo_entrada = fopen(caminho, "rb");
+    if(!arquivo_entrada){
+        printf("\n\tERRO AO ABRIR ARQUIVO ENTRADA.\n");
+        return;
+    }
+
+    FILE *arquivo_saida = fopen(nome_arquivo, "wb");
+    if(!arquivo_saida){
+        printf("\n\tERRO AO CRIAR ARQUIVO SAIDA");
+        fclose(arquivo_entrada);
+        return;
+    }
+
+    long long tam_arq = codificar_adaptativo(arquivo_entrada, arquivo_saida);
+    if(tam_arq < 0)
+        printf("\n\tERRO AO COMPACTAR O ARQUIVO.\n");
+    else
+        printf("\n\tTAMANHO DO ARQUIVO ORIGINAL: %lld bytes\n", tam_arq);
+
+    fclose(arquivo_entrada);
+    fclose(arquivo_saida);
+}
+
 /**
  * @brief Descompacta um arquivo compactado usando Huffman.
  * 
@@ -71,38 +332,394 @@ void descompactar(char *caminho, char *nome_arquivo){
 
     unsigned long tam_arq = tamanho_arquivo(arquivo_entrada);
 
+    LEITOR leitor;
+    ARQUIVO_MAPEADO mapa;
+    if(!abrir_leitor_mapeado(&leitor, &mapa, arquivo_entrada, TAM_BLOCO_IO)){
+        printf("\n\tERRO: MEMORIA INSUFICIENTE.\n");
+        fclose(arquivo_entrada);
+        return;
+    }
+
+    unsigned char assinatura[3] = {0};
+    if(ler_bytes(&leitor, assinatura, 3) == 3 && memcmp(assinatura, ASSINATURA, 2) == 0){
+        if(assinatura[2] == FORMATO_COM_DICIONARIO){
+            printf("\n\tERRO: ARQUIVO COMPACTADO COM DICIONARIO; USE A LINHA DE COMANDO (-d -k).\n");
+            fechar_leitor_mapeado(&leitor, &mapa);
+            fclose(arquivo_entrada);
+            return;
+        }
+        if(assinatura[2] != FORMATO_CANONICO && assinatura[2] != FORMATO_BLOCOS && assinatura[2] != FORMATO_ADAPTATIVO && assinatura[2] != FORMATO_CONTEXTO && assinatura[2] != FORMATO_LARGO){
+            printf("\n\tERRO: VERSAO DE FORMATO DESCONHECIDA (%d).\n", assinatura[2]);
+            fechar_leitor_mapeado(&leitor, &mapa);
+            fclose(arquivo_entrada);
+            return;
+        }
+
+        FILE *arquivo_saida = fopen(nome_arquivo, "wb");
+        if(!arquivo_saida){
+            printf("\n\tERRO AO CRIAR ARQUIVO SAIDA.\n");
+            fechar_leitor_mapeado(&leitor, &mapa);
+            fclose(arquivo_entrada);
+            return;
+        }
+
+        int ok;
+        switch(assinatura[2]){
+        case FORMATO_BLOCOS:{
+            long blocos = descompactar_blocos(&leitor, arquivo_saida, 0);
+            if(blocos >= 0)
+                printf("\n\tBLOCOS DESCOMPACTADOS: %ld\n", blocos);
+            ok = blocos >= 0;
+            break;
+        }
+        case FORMATO_ADAPTATIVO:{
+            ESCRITOR escritor;
+            ok = iniciar_escritor(&escritor, arquivo_saida, TAM_BLOCO_IO) && decodificar_adaptativo_leitor(&leitor, &escritor);
+            liberar_escritor(&escritor);
+            ok = ok && !escritor.erro;
+            break;
+        }
+        case FORMATO_LARGO:
+            ok = decodificar_largo(&leitor, arquivo_saida, tam_arq, TAM_BLOCO_IO);
+            break;
+        case FORMATO_CONTEXTO:
+            ok = decodificar_contexto(&leitor, arquivo_saida, tam_arq, TAM_BLOCO_IO);
+            break;
+        default:
+            ok = decodificar_canonico(&leitor, arquivo_saida, tam_arq, TAM_BLOCO_IO);
+            break;
+        }
+
+        if(!ok)
+            printf("\n\tERRO: ARQUIVO COMPACTADO INVALIDO.\n");
+
+        fechar_leitor_mapeado(&leitor, &mapa);
+        fclose(arquivo_entrada);
+        fclose(arquivo_saida);
+        return;
+    }
+    reiniciar_leitor(&leitor);
+
     unsigned short tam_lixo;
     unsigned short tam_arvore;
 
-    ler_cabecalho(arquivo_entrada, &tam_lixo, &tam_arvore);
+    ler_cabecalho(&leitor, &tam_lixo, &tam_arvore);
+    printf("\n\tTamanho Lixo: %d\n", tam_lixo);
+    printf("\n\tTamanho Arvore: %d\n", tam_arvore);
 
     FILE *arquivo_saida = fopen(nome_arquivo, "wb");
     if(!arquivo_saida){
         printf("\n\tERRO AO CRIAR ARQUIVO SAIDA.\n");
+        fechar_leitor_mapeado(&leitor, &mapa);
+        fclose(arquivo_entrada);
         return;
     }
 
-    decodificar(arquivo_entrada, arquivo_saida, tam_arq, tam_lixo, tam_arvore);
+    if(!decodificar(&leitor, arquivo_saida, tam_arq, tam_lixo, tam_arvore, TAM_BLOCO_IO))
+        printf("\n\tERRO: ARQUIVO COMPACTADO INVALIDO.\n");
+
+    fechar_leitor_mapeado(&leitor, &mapa);
+    fclose(arquivo_entrada);
+    fclose(arquivo_saida);
+}
+
+/**
+ * @brief Coloca um arquivo padrão (stdin ou stdout) em modo binário. Só tem efeito no Windows.
+ * 
+ * @param arquivo Arquivo padrão.
+ */
+void modo_binario(FILE *arquivo){
+#ifdef _WIN32
+    _setmode(_fileno(arquivo), _O_BINARY);
+#else
+    (void)arquivo;
+#endif
+}
+
+/**
+ * @brief Lê toda a entrada para a memória.
+ * 
+ * @param arquivo Arquivo de entrada.
+ * @param inicio Bytes já lidos da entrada, que ficam no início dos dados (pode ser NULL).
+ * @param tam_inicio Quantidade de bytes já lidos.
+ * @param tamanho Ponteiro para guardar o tamanho total dos dados.
+ * @return unsigned char* Dados lidos (liberados com free) ou NULL em caso de erro.
+ */
+unsigned char *ler_entrada(FILE *arquivo, const unsigned char *inicio, size_t tam_inicio, size_t *tamanho){
+    size_t capacidade = tam_inicio + 4096;
+    unsigned char *dados = malloc(capacidade);
+    if(!dados) return NULL;
+
+    if(tam_inicio > 0) memcpy(dados, inicio, tam_inicio);
+    *tamanho = tam_inicio;
+
+    for(;;){
+        if(*tamanho == capacidade){
+            unsigned char *novo = realloc(dados, capacidade * 2);
+            if(!novo){
+                free(dados);
+                return NULL;
+            }
+            dados = novo;
+            capacidade *= 2;
+        }
+
+        size_t lidos = fread(dados + *tamanho, 1, capacidade - *tamanho, arquivo);
+        if(lidos == 0) break;
+        *tamanho += lidos;
+    }
+
+    if(ferror(arquivo)){
+        free(dados);
+        return NULL;
+    }
+    return dados;
+}
+
+/**
+ * @brief Treina um dicionário com todos os bytes da entrada e o grava na saída.
+ * 
+ * @param arquivo_entrada Corpus de exemplo (por exemplo, várias mensagens concatenadas).
+ * @param arquivo_saida Arquivo do dicionário.
+ * @param max_bits Tamanho máximo dos códigos (0 usa BITS_DICIONARIO).
+ * @return long long Quantidade de bytes de exemplo lidos ou -1 em caso de erro.
+ */
+long long treinar(FILE *arquivo_entrada, FILE *arquivo_saida, int max_bits){
+    unsigned long frequencia[TAM_ASCII] = {0};
+    long long total = 0;
+
+    LEITOR leitor;
+    if(!iniciar_leitor(&leitor, arquivo_entrada, TAM_BLOCO_IO))
+        return -1;
+    while(recarregar_leitor(&leitor) > 0){
+        histograma(leitor.dados, leitor.tamanho, frequencia);
+        total += leitor.tamanho;
+    }
+    liberar_leitor(&leitor);
+
+    DICIONARIO dicionario;
+    if(!treinar_dicionario(&dicionario, frequencia, max_bits))
+        return -1;
+
+    int ok = salvar_dicionario(&dicionario, arquivo_saida);
+    liberar_dicionario(&dicionario);
+    return ok ? total : -1;
+}
+
+/**
+ * @brief Compacta ou descompacta toda a entrada como uma única mensagem, com um dicionário.
+ * 
+ * @param dicionario Ponteiro para o dicionário.
+ * @param arquivo_entrada Arquivo de entrada.
+ * @param arquivo_saida Arquivo de saída.
+ * @param assinatura Bytes já lidos da entrada na descompactação (NULL na compactação).
+ * @return long long Tamanho da saída ou -1 em caso de erro.
+ */
+long long mensagem_com_dicionario(const DICIONARIO *dicionario, FILE *arquivo_entrada, FILE *arquivo_saida, const unsigned char *assinatura){
+    size_t tam_entrada;
+    unsigned char *entrada = ler_entrada(arquivo_entrada, assinatura, assinatura ? 3 : 0, &tam_entrada);
+    if(!entrada) return -1;
+
+    size_t capacidade = assinatura ? limite_descompactado_dicionario(dicionario, tam_entrada) : limite_com_dicionario(dicionario, tam_entrada);
+    unsigned char *saida = malloc(capacidade > 0 ? capacidade : 1);
+    long long tam_saida = -1;
+
+    if(saida){
+        if(assinatura)
+            tam_saida = descompactar_com_dicionario(dicionario, entrada, tam_entrada, saida, capacidade);
+        else
+            tam_saida = compactar_com_dicionario(dicionario, entrada, tam_entrada, saida, capacidade);
+    }
+    if(tam_saida > 0 && fwrite(saida, 1, tam_saida, arquivo_saida) != (size_t)tam_saida)
+        tam_saida = -1;
+
+    free(entrada);
+    free(saida);
+    return tam_saida;
+}
+
+/**
+ * @brief Mostra o uso da linha de comando na saída de erro.
+ * 
+ * @param programa Nome do programa.
+ */
+void mostrar_uso(const char *programa){
+    fprintf(stderr, "uso: %s -c|-a|-d|-T [-t threads] [-l max_bits] [-k dicionario] [-i] [-4] [-r inicio:quantidade] [entrada [saida]]\n", programa);
+    fprintf(stderr, "  -c  compacta no formato em blocos (ou como uma mensagem, com -k)\n");
+    fprintf(stderr, "  -a  compacta com Huffman adaptativo (cada trecho lido sai na hora)\n");
+    fprintf(stderr, "  -d  descompacta dados no formato em blocos, adaptativo ou com dicionario\n");
+    fprintf(stderr, "  -T  treina um dicionario com os bytes da entrada e grava o dicionario na saida\n");
+    fprintf(stderr, "  -t  quantidade de threads (0 usa todos os processadores)\n");
+    fprintf(stderr, "  -l  tamanho maximo dos codigos, de 1 a %d bits (0 sem limite; com -T, de 8 a %d, 0 usa %d)\n", MAX_BITS_CODIGO, MAX_BITS_DICIONARIO, BITS_DICIONARIO);
+    fprintf(stderr, "  -k  dicionario usado para compactar e descompactar mensagens pequenas\n");
+    fprintf(stderr, "  -i  com -c, grava no fim o indice dos blocos e a soma de verificacao de cada um\n");
+    fprintf(stderr, "  -4  com -c, grava cada bloco em quatro fluxos de bits, que descompactam mais rapido\n");
+    fprintf(stderr, "  -r  com -d, descompacta so o trecho pedido dos dados originais (a entrada precisa ter indice e ser um arquivo)\n");
+    fprintf(stderr, "Sem arquivos, ou com \"-\", le da entrada padrao e escreve na saida padrao.\n");
+}
+
+/**
+ * @brief Compacta ou descompacta pela linha de comando, sem o menu.
+ * 
+ * Usa o formato em blocos ou o adaptativo, que são gravados e lidos em uma única passada: o
+ * cabeçalho de cada bloco vem antes dos seus dados e nenhum arquivo é reposicionado. Assim a
+ * entrada e a saída podem ser pipes, e a memória usada não depende do tamanho dos dados. No modo
+ * adaptativo, a saída de cada trecho lido é entregue sem esperar o resto da entrada. Com um
+ * dicionário (-k), a entrada inteira é uma única mensagem, compactada sem árvore no cabeçalho.
+ * Com -r, só os blocos que cobrem o trecho pedido são lidos, o que exige um arquivo gravado com -i.
+ * 
+ * @param argc Quantidade de argumentos.
+ * @param argv Argumentos do programa.
+ * @return int 0 para sucesso, 1 em caso de erro ou 2 se os argumentos forem inválidos.
+ */
+int linha_de_comando(int argc, char *argv[]){
+    int modo = 0, n_threads = 0, max_bits = 0, n_caminhos = 0, com_indice = 0, quatro_fluxos = 0, intervalo = 0;
+    const char *caminhos[2] = {"-", "-"};
+    const char *caminho_dicionario = NULL;
+    unsigned long long inicio = 0, quantidade = 0;
+
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "-T") == 0)
+            modo = argv[i][1];
+        else if(strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            n_threads = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+            max_bits = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-k") == 0 && i + 1 < argc)
+            caminho_dicionario = argv[++i];
+        else if(strcmp(argv[i], "-i") == 0)
+            com_indice = 1;
+        else if(strcmp(argv[i], "-4") == 0)
+            quatro_fluxos = 1;
+        else if(strcmp(argv[i], "-r") == 0 && i + 1 < argc && sscanf(argv[i + 1], "%llu:%llu", &inicio, &quantidade) == 2){
+            intervalo = 1;
+            i++;
+        }
+        else if((argv[i][0] != '-' || argv[i][1] == '\0') && n_caminhos < 2)
+            caminhos[n_caminhos++] = argv[i];
+        else{
+            mostrar_uso(argv[0]);
+            return 2;
+        }
+    }
+
+    if(!modo || n_threads < 0 || max_bits < 0 || max_bits > MAX_BITS_CODIGO || (caminho_dicionario && (modo == 'a' || modo == 'T')) ||
+       ((com_indice || quatro_fluxos) && (modo != 'c' || caminho_dicionario)) || (intervalo && (modo != 'd' || caminho_dicionario || strcmp(caminhos[0], "-") == 0))){
+        mostrar_uso(argv[0]);
+        return 2;
+    }
+
+    DICIONARIO dicionario;
+    if(caminho_dicionario){
+        FILE *arquivo_dicionario = fopen(caminho_dicionario, "rb");
+        int ok = arquivo_dicionario && carregar_dicionario(&dicionario, arquivo_dicionario);
+        if(arquivo_dicionario) fclose(arquivo_dicionario);
+        if(!ok){
+            fprintf(stderr, "ERRO: DICIONARIO INVALIDO: %s\n", caminho_dicionario);
+            return 1;
+        }
+    }
+
+    FILE *arquivo_entrada = stdin, *arquivo_saida = stdout;
+
+    if(strcmp(caminhos[0], "-") == 0)
+        modo_binario(stdin);
+    else if(!(arquivo_entrada = fopen(caminhos[0], "rb"))){
+        fprintf(stderr, "ERRO AO ABRIR ARQUIVO ENTRADA: %s\n", caminhos[0]);
+        if(caminho_dicionario) liberar_dicionario(&dicionario);
+        return 1;
+    }
+
+    if(strcmp(caminhos[1], "-") == 0)
+        modo_binario(stdout);
+    else if(!(arquivo_saida = fopen(caminhos[1], "wb"))){
+        fprintf(stderr, "ERRO AO CRIAR ARQUIVO SAIDA: %s\n", caminhos[1]);
+        if(arquivo_entrada != stdin) fclose(arquivo_entrada);
+        if(caminho_dicionario) liberar_dicionario(&dicionario);
+        return 1;
+    }
+
+    long long resultado = -1;
+
+    if(modo == 'T'){
+        resultado = treinar(arquivo_entrada, arquivo_saida, max_bits);
+    }else if(modo == 'c' && caminho_dicionario){
+        resultado = mensagem_com_dicionario(&dicionario, arquivo_entrada, arquivo_saida, NULL);
+    }else if(modo == 'c'){
+        resultado = compactar_blocos(arquivo_entrada, arquivo_saida, TAM_BLOCO_HUFFMAN, max_bits, n_threads, com_indice, quatro_fluxos);
+    }else if(modo == 'a'){
+        resultado = codificar_adaptativo(arquivo_entrada, arquivo_saida);
+    }else if(intervalo){
+        resultado = descompactar_intervalo(arquivo_entrada, arquivo_saida, inicio, quantidade);
+        if(resultado < 0)
+            fprintf(stderr, "ERRO: A ENTRADA NAO TEM INDICE DE BLOCOS OU ESTA CORROMPIDA.\n");
+    }else{
+        // A assinatura é lida sem o stdio, para o modo adaptativo continuar lendo direto do arquivo
+        unsigned char assinatura[3] = {0};
+        long lidos = 0, parte = 1;
+        while(lidos < 3 && (parte = ler_disponivel(arquivo_entrada, assinatura + lidos, 3 - lidos)) > 0)
+            lidos += parte;
+
+        LEITOR leitor;
+        if(lidos < 3 || memcmp(assinatura, ASSINATURA, 2) != 0 ||
+           (assinatura[2] != FORMATO_BLOCOS && assinatura[2] != FORMATO_ADAPTATIVO && assinatura[2] != FORMATO_COM_DICIONARIO))
+            fprintf(stderr, "ERRO: A ENTRADA NAO ESTA NO FORMATO EM BLOCOS, ADAPTATIVO OU COM DICIONARIO.\n");
+        else if(assinatura[2] == FORMATO_COM_DICIONARIO && !caminho_dicionario)
+            fprintf(stderr, "ERRO: A ENTRADA FOI COMPACTADA COM UM DICIONARIO; INFORME-O COM -k.\n");
+        else if(assinatura[2] == FORMATO_COM_DICIONARIO)
+            resultado = mensagem_com_dicionario(&dicionario, arquivo_entrada, arquivo_saida, assinatura);
+        else if(assinatura[2] == FORMATO_ADAPTATIVO)
+            resultado = decodificar_adaptativo(arquivo_entrada, arquivo_saida) ? 0 : -1;
+        else if(iniciar_leitor(&leitor, arquivo_entrada, TAM_BLOCO_IO)){
+            resultado = descompactar_blocos(&leitor, arquivo_saida, n_threads);
+            liberar_leitor(&leitor);
+        }
+    }
+
+    if(fflush(arquivo_saida) != 0) resultado = -1;
+    if(resultado < 0)
+        fprintf(stderr, "ERRO AO %s OS DADOS.\n", modo == 'd' ? "DESCOMPACTAR" : modo == 'T' ? "TREINAR" : "COMPACTAR");
+
+    if(arquivo_entrada != stdin) fclose(arquivo_entrada);
+    if(arquivo_saida != stdout && fclose(arquivo_saida) != 0) resultado = -1;
+    if(caminho_dicionario) liberar_dicionario(&dicionario);
+
+    return resultado < 0;
 }
 
 /**
  * @brief Função principal do programa, que apresenta o menu e chama os métodos de compactação e descompactação.
  * 
+ * Com argumentos, o programa funciona pela linha de comando (veja linha_de_comando) em vez do menu.
+ * 
+ * @param argc Quantidade de argumentos.
+ * @param argv Argumentos do programa.
  * @return int 0 para sucesso.
  */
-int main(){
+int main(int argc, char *argv[]){
+    if(argc > 1)
+        return linha_de_comando(argc, argv);
+
     int escolha;
 
+#ifdef _WIN32
     SetConsoleOutputCP(65001);
+#endif
 
     printf("\n\t=== COMPRESSOR HUFFMAN ===\n");
     printf("\n\tDigite uma opcao:");
-    printf("\n\t1 - Compactar\n\t2 - Descompactar\n\t0 - Sair\n\n\tescolha: ");
+    printf("\n\t1 - Compactar\n\t2 - Descompactar\n\t3 - Compactar (codigos canonicos)\n\t4 - Compactar (codigos canonicos com tamanho maximo)\n\t5 - Compactar em blocos (varias threads)\n\t6 - Compactar (Huffman adaptativo)\n\t7 - Compactar (contexto de ordem 1)\n\t8 - Compactar (simbolos de 16 bits)\n\t0 - Sair\n\n\tescolha: ");
     scanf("%d", &escolha);
     getchar(); // Remove o '\n' do texto
 
     switch (escolha){
-    case 1:{
+    case 1:
+    case 3:
+    case 4:
+    case 5:
+    case 6:
+    case 7:
+    case 8:{
         printf("\n\tDIGITE O CAMINHO COMPLETO DO ARQUIVO QUE DESEJA ABRIR: ");
 
         char caminho[MAX_LEITURA];
@@ -132,7 +749,32 @@ int main(){
         nome_arquivo[strcspn(nome_arquivo, "\n")] = '\0'; 
         strcat(nome_arquivo, ".huff");
 
-        compactar(caminho, nome_arquivo);
+        if(escolha == 4){
+            int max_bits;
+            printf("\n\tDIGITE O TAMANHO MAXIMO DOS CODIGOS (1 A %d BITS): ", MAX_BITS_CODIGO);
+            if(scanf("%d", &max_bits) != 1 || max_bits < 1 || max_bits > MAX_BITS_CODIGO){
+                printf("\n\tERRO: TAMANHO MAXIMO INVALIDO.\n");
+                break;
+            }
+            compactar_canonico(caminho, nome_arquivo, max_bits);
+        }else if(escolha == 5){
+            int n_threads;
+            printf("\n\tDIGITE A QUANTIDADE DE THREADS (0 PARA USAR TODOS OS %d PROCESSADORES): ", numero_processadores());
+            if(scanf("%d", &n_threads) != 1 || n_threads < 0){
+                printf("\n\tERRO: QUANTIDADE DE THREADS INVALIDA.\n");
+                break;
+            }
+            compactar_em_blocos(caminho, nome_arquivo, n_threads);
+        }else if(escolha == 6)
+            compactar_adaptativo(caminho, nome_arquivo);
+        else if(escolha == 7)
+            compactar_contexto(caminho, nome_arquivo);
+        else if(escolha == 8)
+            compactar_largo(caminho, nome_arquivo);
+        else if(escolha == 3)
+            compactar_canonico(caminho, nome_arquivo, 0);
+        else
+            compactar(caminho, nome_arquivo);
 
         break;
     }
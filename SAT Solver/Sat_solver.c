@@ -1,160 +1,1093 @@
+// Expõe mmap, posix_madvise e sysconf mesmo quando o compilador usa -std=c11 estrito
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
 #include <stdio.h>
 #include <string.h> 
 #include <stdlib.h>
 #include <stdbool.h> 
-#define MAX 100 
-
-//---------Árvore-----------
-typedef struct tree{
-    int var ; // Varialvel
-    bool result ; // Resultado da interpretação parcial
-    struct tree *direita; // Nó para a direita FALSE 
-    struct tree *esquerda; // Nó para a esquerda TRUE
-}tree;
-//----- Nos ------
-typedef struct node {
-    int item;
-    struct node *next;
-}node;
-//---- Literais -----
-typedef struct clausula{
-    node *literias; // Literias x1 , x2 ,x3 ..... e já vê se ele está negado
-    struct clausula *next; // Ponteiro para o próximo nó de literais
-}clausula;
+#include <limits.h>
+#include <stdatomic.h>
+#include <pthread.h> // No Windows, compile com a winpthreads do MinGW
+#ifdef _WIN32
+#include <windows.h>
+#define MAPEAMENTO 0 // Sem mmap: o arquivo é lido inteiro para a memória
+#else
+#define MAPEAMENTO 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#define MAX_VARIAVEIS (1 << 29) // Maior variável aceita, para que os índices de literal caibam em um int
+// Literal x (ou -x) vira o índice 2*(x-1) (ou 2*(x-1)+1), para indexar listas por literal
+#define IDX(lit) ((lit) > 0 ? 2 * ((lit) - 1) : 2 * (-(lit) - 1) + 1)
+#define VAR(lit) (abs(lit) - 1)
+
+//---- Vetor de inteiros que cresce sob demanda -----
+typedef struct vetor_int{
+    int *dados;
+    int tam;
+    int cap;
+}vetor_int;
+//---- Banco de cláusulas ------
+typedef struct banco_clausulas{
+    vetor_int literais; // Literais de todas as cláusulas, uma após a outra ( x1 , -x2 ... já com o sinal)
+    vetor_int inicio; // Posição em literais onde começa cada cláusula
+    vetor_int tam; // Quantidade de literais de cada cláusula
+}banco_clausulas;
 //---- representação da formula ------
 typedef struct formula{
     int num_variaveis; // Número de variáveis 
     int num_setencas ; // Número de seteças
-    clausula *inicio ;    // lista de cláusulas
+    banco_clausulas clausulas;
 }formula;
 
-node *creat_linked_list (){ // Inicializa a lista encadeada
-    return NULL;
+void empilhar (vetor_int *v, int x){
+    if (v->tam == v->cap){
+        v->cap = v->cap ? 2 * v->cap : 4;
+        v->dados = (int*)realloc(v->dados, v->cap * sizeof(int));
+    }
+    v->dados[v->tam++] = x;
+}
+void reservar (vetor_int *v, int cap){ // Garante espaço para cap elementos sem realocar depois
+    if (v->cap < cap){
+        v->cap = cap;
+        v->dados = (int*)realloc(v->dados, v->cap * sizeof(int));
+    }
+}
+//------ Banco de cláusulas: literais contíguos, cláusulas por posição --------
+int *literais_clausula (banco_clausulas *B, int c){
+    return B->literais.dados + B->inicio.dados[c];
+}
+void fechar_clausula (banco_clausulas *B, int inicio){ // Os literais de literais.dados[inicio..] formam uma cláusula nova
+    empilhar(&B->inicio, inicio);
+    empilhar(&B->tam, B->literais.tam - inicio);
+}
+void liberar_banco (banco_clausulas *B){
+    free(B->literais.dados);
+    free(B->inicio.dados);
+    free(B->tam.dados);
+}
+//------Arquivo .cnf na memória--------
+typedef struct arquivo_cnf{
+    const char *dados;
+    size_t tam;
+    bool mapeado; // true se veio de mmap, false se foi lido com fread
+}arquivo_cnf;
+
+bool abrir_cnf (const char *caminho, arquivo_cnf *A){ // Mapeia o arquivo inteiro, sem copiar (ou lê, sem mmap)
+    A->dados = "";
+    A->tam = 0;
+    A->mapeado = false;
+#if MAPEAMENTO
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0){
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0){
+        close(fd);
+        return false;
+    }
+    if (info.st_size > 0){
+        void *mapa = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapa == MAP_FAILED){
+            close(fd);
+            return false;
+        }
+        posix_madvise(mapa, info.st_size, POSIX_MADV_SEQUENTIAL); // Leitura de uma passada: o kernel pode ler adiante
+        A->dados = (const char*)mapa;
+        A->tam = info.st_size;
+        A->mapeado = true;
+    }
+    close(fd);
+    return true;
+#else
+    FILE *fp = fopen(caminho, "rb");
+    if (fp == NULL){
+        return false;
+    }
+    char *buffer = NULL;
+    size_t lidos = 0, cap = 0, n;
+    do {
+        if (lidos == cap){
+            cap = cap ? 2 * cap : 1 << 20;
+            buffer = (char*)realloc(buffer, cap);
+        }
+        n = fread(buffer + lidos, 1, cap - lidos, fp);
+        lidos += n;
+    } while (n > 0);
+    fclose(fp);
+    A->dados = buffer;
+    A->tam = lidos;
+    return true;
+#endif
 }
-//------- Criando uma arvore-------
-tree *creat_binary_tree ( int var, int max_vars){
-    if (var > max_vars){ // Caso o número de var for maior do que aquele fornecido pelo o arquivo
-        return NULL;
-    }
-    tree *root = (tree*) malloc(sizeof(tree));
-    root->var = var;
-    // Filho esquerda (TRUE)
-    root->esquerda = creat_binary_tree( var + 1, max_vars); // Var começa com 0  e vai aumentando de pouco a pouco até chegar no limite
-
-    // Filho direito (FALSE)
-    root->direita = creat_binary_tree( var + 1, max_vars);
-    return root;
-}
-//------Adiciona elementos aos literais--------
-node *add_literal (node *head, int var){
-    node *new_node = (node*)malloc(sizeof(node));
-    new_node->item = var ;
-    new_node->next = NULL;
-    
-    // Isso aqui tudo ésó para adicionar na ordem que tá no arquivo
-    if (head == NULL){
-        return new_node;
-    }
-    node *temp = head; 
-    while (temp->next != NULL){
-        temp = temp->next;
-    }
-    temp->next = new_node;
-    return head;
-}
-//---------Adiciona elementos as cláusulas--------
-clausula *add_clausula (clausula *head, node *lit){
-    clausula *new_clausula = (clausula*)malloc(sizeof(clausula));
-    new_clausula->literias = lit;
-    new_clausula->next = NULL; // Não tem mais nenhuma cláusula a ser adicionada na lista ; Por enquanto
-
-    if (head == NULL){ // Não tem nenhum elemento anterior 
-        return new_clausula; // Retorna a lista de cláusula atual
-    }
-    clausula *temp = head;
-
-    while (temp->next != NULL){ // Caso tenha algum elemento, pecorremos até o ultimo nó
-        temp = temp->next ;
-    }
-    temp->next = new_clausula; // Adicionamos a novo cláusula no fim da lista 
-    return head ; 
-}
-//------Leitura do arquivo .cnf--------
-formula read_formula (FILE *fp){
-    formula F; 
-    F.inicio = NULL;
-    F.num_setencas = 0;
-    F.num_variaveis = 0;
-
-    char line[MAX];
-
-    while (fgets(line, MAX, fp)){
-        if (line[0] == 'c'){ // ignora comentários
+void fechar_cnf (arquivo_cnf *A){
+#if MAPEAMENTO
+    if (A->mapeado){
+        munmap((void*)A->dados, A->tam);
+    }
+#else
+    if (A->tam > 0){
+        free((void*)A->dados);
+    }
+#endif
+}
+//------Leitura do formato DIMACS--------
+bool ler_inteiro (const char **p, const char *fim, int *valor){ // Converte um inteiro com sinal direto do texto, sem cópia
+    const char *q = *p;
+    bool negativo = q < fim && *q == '-';
+    if (negativo){
+        q++;
+    }
+    if (q == fim || *q < '0' || *q > '9'){
+        return false;
+    }
+    long long v = 0;
+    while (q < fim && *q >= '0' && *q <= '9'){
+        v = 10 * v + (*q++ - '0');
+        if (v > MAX_VARIAVEIS){
+            return false;
+        }
+    }
+    if (q < fim && *q > ' '){ // O número tem que terminar em espaço ou quebra de linha
+        return false;
+    }
+    *p = q;
+    *valor = negativo ? -(int)v : (int)v;
+    return true;
+}
+const char *pular_linha (const char *p, const char *fim){
+    const char *q = memchr(p, '\n', fim - p);
+    return q ? q + 1 : fim;
+}
+bool read_formula (const char *dados, size_t tam, formula *F){ // Cláusulas podem ocupar várias linhas e as linhas podem ter qualquer tamanho
+    memset(F, 0, sizeof(formula));
+    const char *p = dados, *fim = dados + tam;
+    int inicio = 0; // Onde começa a cláusula em leitura
+
+    while (p < fim){
+        char ch = *p;
+        if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r'){
+            p++;
             continue;
         }
-        if (line[0] == 'p'){ // Lê cabeçalho
-            sscanf(line, "p cnf %d %d", &F.num_variaveis, &F.num_setencas);
+        if (ch == 'c'){ // ignora comentários
+            p = pular_linha(p, fim);
+            continue;
+        }
+        if (ch == '%'){ // Fim dos dados nos arquivos do SATLIB
+            break;
+        }
+        if (ch == 'p'){ // Lê cabeçalho
+            p++;
+            while (p < fim && (*p == ' ' || *p == '\t')){
+                p++;
+            }
+            if (fim - p < 3 || memcmp(p, "cnf", 3) != 0){
+                return false;
+            }
+            p += 3;
+            for (int i = 0; i < 2; i++){
+                while (p < fim && (*p == ' ' || *p == '\t')){
+                    p++;
+                }
+                if (!ler_inteiro(&p, fim, i == 0 ? &F->num_variaveis : &F->num_setencas) || F->num_variaveis < 0 || F->num_setencas < 0){
+                    return false;
+                }
+            }
+            // O cabeçalho diz quantas cláusulas vêm: reserva tudo de uma vez (literais: estimativa de 3 por cláusula).
+            // Cada cláusula ocupa ao menos 2 bytes do arquivo, o que limita um cabeçalho exagerado
+            size_t clausulas = F->num_setencas < (fim - p) / 2 ? (size_t)F->num_setencas : (size_t)(fim - p) / 2;
+            reservar(&F->clausulas.inicio, clausulas);
+            reservar(&F->clausulas.tam, clausulas);
+            reservar(&F->clausulas.literais, 3 * clausulas < (size_t)(fim - p) / 2 ? 3 * clausulas : (size_t)(fim - p) / 2);
+            p = pular_linha(p, fim);
             continue;
         }
 
-        int lit; 
-        node *lit_head = creat_linked_list();
+        int lit;
+        if (!ler_inteiro(&p, fim, &lit)){
+            return false;
+        }
+        if (lit == 0){
+            fechar_clausula(&F->clausulas, inicio);
+            inicio = F->clausulas.literais.tam;
+        }
+        else {
+            empilhar(&F->clausulas.literais, lit);
+            if (abs(lit) > F->num_variaveis){ // Garante espaço para variáveis além do cabeçalho
+                F->num_variaveis = abs(lit);
+            }
+        }
+    }
+    if (F->clausulas.literais.tam > inicio){ // Última cláusula sem o 0 final
+        fechar_clausula(&F->clausulas, inicio);
+    }
+    return true;
+}
+//---------Avaliação incremental-----------
+// Cada cláusula conta seus literais TRUE e sem valor; as listas de ocorrência dizem quais cláusulas
+// mudam quando um literal é atribuído. Assim conflito e satisfação aparecem no momento da atribuição.
+typedef struct avaliador{
+    int *verdadeiros; // Por cláusula: literais TRUE
+    int *livres; // Por cláusula: literais ainda sem valor
+    int satisfeitas; // Cláusulas com ao menos um literal TRUE
+    int falsas; // Cláusulas com todos os literais FALSE
+    int num_clausulas;
+    int num_variaveis;
+    vetor_int *ocorrencias; // Por literal: cláusulas em que ele aparece
+}avaliador;
 
-        char *token = strtok(line, " \n");
-        while (token != NULL){
-            lit = atoi(token);
-            if (lit == 0){
-                F.inicio = add_clausula(F.inicio, lit_head);
-                lit_head = NULL;
+void iniciar_avaliador (avaliador *A, formula *F){
+    banco_clausulas *B = &F->clausulas;
+    A->num_clausulas = B->inicio.tam;
+    A->num_variaveis = F->num_variaveis;
+    A->verdadeiros = (int*)calloc(A->num_clausulas + 1, sizeof(int));
+    A->livres = (int*)malloc((A->num_clausulas + 1) * sizeof(int));
+    A->ocorrencias = (vetor_int*)calloc(2 * F->num_variaveis + 1, sizeof(vetor_int));
+    A->satisfeitas = 0;
+    A->falsas = 0;
+    for (int c = 0; c < A->num_clausulas; c++){
+        A->livres[c] = B->tam.dados[c];
+        if (A->livres[c] == 0){ // Cláusula vazia: falsa desde o início
+            A->falsas++;
+        }
+        int *lt = literais_clausula(B, c);
+        for (int k = 0; k < B->tam.dados[c]; k++){
+            empilhar(&A->ocorrencias[IDX(lt[k])], c);
+        }
+    }
+}
+
+void liberar_avaliador (avaliador *A){
+    for (int i = 0; i < 2 * A->num_variaveis + 1; i++){
+        free(A->ocorrencias[i].dados);
+    }
+    free(A->ocorrencias);
+    free(A->verdadeiros);
+    free(A->livres);
+}
+
+void avaliar_atribuicao (avaliador *A, int lit){ // lit passa a ser TRUE (e -lit, FALSE)
+    vetor_int *oc = &A->ocorrencias[IDX(lit)];
+    for (int i = 0; i < oc->tam; i++){
+        int c = oc->dados[i];
+        A->livres[c]--;
+        if (A->verdadeiros[c]++ == 0){
+            A->satisfeitas++;
+        }
+    }
+    oc = &A->ocorrencias[IDX(-lit)];
+    for (int i = 0; i < oc->tam; i++){
+        int c = oc->dados[i];
+        if (--A->livres[c] == 0 && A->verdadeiros[c] == 0){
+            A->falsas++;
+        }
+    }
+}
+
+void desfazer_atribuicao (avaliador *A, int lit){ // Inverso exato de avaliar_atribuicao
+    vetor_int *oc = &A->ocorrencias[IDX(lit)];
+    for (int i = 0; i < oc->tam; i++){
+        int c = oc->dados[i];
+        A->livres[c]++;
+        if (--A->verdadeiros[c] == 0){
+            A->satisfeitas--;
+        }
+    }
+    oc = &A->ocorrencias[IDX(-lit)];
+    for (int i = 0; i < oc->tam; i++){
+        int c = oc->dados[i];
+        if (A->livres[c]++ == 0 && A->verdadeiros[c] == 0){
+            A->falsas--;
+        }
+    }
+}
+//---------Busca exaustiva-----------
+// A trilha guarda o literal atribuído em cada nível (x1, x2 ... nessa ordem) e faz o papel da pilha de decisões:
+// +x é o primeiro ramo (TRUE) e -x indica que o ramo FALSE já está sendo explorado. Memória O(n), sem árvore.
+// O avaliador corta o ramo assim que uma cláusula fica falsa e para assim que todas estão satisfeitas.
+bool SAT_SOLVER (formula *F, bool *interpretacoes){
+    int n = F->num_variaveis;
+    int *trilha = (int*)malloc((n + 1) * sizeof(int));
+    avaliador A;
+    iniciar_avaliador(&A, F);
+    int nivel = 0;
+    bool sat = false;
+    for (;;){
+        if (A.falsas == 0){
+            if (A.satisfeitas == A.num_clausulas){ // Todas satisfeitas: as variáveis que faltam não importam
+                for (int i = nivel; i < n; i++){
+                    interpretacoes[i] = true;
+                }
+                sat = true;
+                break;
             }
-            else {
-                lit_head = add_literal(lit_head, lit);
+            if (nivel < n){ // Desce: próxima variável começa em TRUE
+                trilha[nivel] = nivel + 1;
+                interpretacoes[nivel] = true;
+                avaliar_atribuicao(&A, trilha[nivel]);
+                nivel++;
+                continue;
             }
-            token = strtok(NULL, " \n");
+        }
+        while (nivel > 0 && trilha[nivel - 1] < 0){ // Conflito: sobe enquanto os dois ramos já foram vistos
+            desfazer_atribuicao(&A, trilha[--nivel]);
+        }
+        if (nivel == 0){
+            break;
+        }
+        desfazer_atribuicao(&A, trilha[nivel - 1]); // Troca TRUE por FALSE no nível mais fundo com ramo pendente
+        trilha[nivel - 1] = -trilha[nivel - 1];
+        interpretacoes[nivel - 1] = false;
+        avaliar_atribuicao(&A, trilha[nivel - 1]);
+    }
+    liberar_avaliador(&A);
+    free(trilha);
+    return sat;
+}
+//---------Solver CDCL-----------
+#define INDEFINIDO -1
+#define REINICIO_LUBY 0 // Reinícios a cada unidade * luby(i) conflitos
+#define REINICIO_GEOMETRICO 1 // Reinícios a cada unidade * 1,5^i conflitos
+
+//---- Parâmetros de busca (no portfólio, cada thread usa uma combinação diferente) -----
+typedef struct configuracao{
+    unsigned long long semente; // 0: busca determinística
+    double decaimento; // VSIDS: o incremento é dividido por ele a cada conflito
+    int reinicio; // REINICIO_LUBY ou REINICIO_GEOMETRICO
+    int unidade_reinicio; // Conflitos até o primeiro reinício
+    double frequencia_aleatoria; // Fração das decisões sorteadas em vez de tiradas do heap
+    bool fase_verdadeira; // Valor tentado primeiro em cada variável, antes de haver fase salva
+}configuracao;
+
+const configuracao PADRAO = {0, 0.95, REINICIO_LUBY, 100, 0.0, false};
+
+//---- Estado compartilhado pelas threads do portfólio -----
+#define TAM_MAX_COMPARTILHADA 2 // Só unitárias e binárias de LBD baixo vão para as outras threads; maiores atrapalham as instâncias satisfazíveis
+#define LBD_MAX_COMPARTILHADA 2
+typedef struct portfolio{
+    formula *F;
+    atomic_int parar; // Alguma thread já respondeu: as outras devem sair
+    pthread_mutex_t trava; // Protege tudo abaixo
+    vetor_int compartilhadas; // Cada cláusula: tamanho, LBD, thread de origem e os literais
+    long long base; // Posição absoluta do primeiro int ainda guardado (o que todas já leram é descartado)
+    long long *lidas; // Por thread: posição absoluta até onde já importou (LLONG_MAX quando a thread sai)
+    int n_threads;
+    int resultado; // 1 SAT, 0 UNSAT ou -1 enquanto ninguém respondeu
+    int vencedora; // Thread que respondeu primeiro
+    bool *interpretacao;
+}portfolio;
+
+typedef struct solver{
+    int num_variaveis;
+    banco_clausulas banco; // Originais seguidas das aprendidas; os dois primeiros literais são os observados
+    vetor_int lbd; // Níveis distintos da cláusula aprendida quando foi criada (0 nas originais)
+    int num_originais;
+    vetor_int *observadores; // Por literal: cláusulas que observam aquele literal
+    signed char *valor; // Por variável: 1 (TRUE), 0 (FALSE) ou INDEFINIDO
+    signed char *fase; // Último valor de cada variável, reaproveitado nas decisões
+    int *nivel; // Nível de decisão em que a variável foi atribuída
+    int *razao; // Cláusula que implicou a variável (-1 para decisões)
+    int *trilha; // Literais verdadeiros, na ordem em que foram atribuídos
+    int tam_trilha;
+    int propagados; // Posição da trilha até onde já houve propagação
+    vetor_int limites; // Início de cada nível de decisão na trilha
+    double *atividade; // VSIDS: variáveis presentes em conflitos recentes são escolhidas antes
+    double incremento;
+    int *heap; // Heap de variáveis livres, ordenado pela atividade
+    int *pos_heap; // Posição de cada variável no heap (-1 se fora dele)
+    int tam_heap;
+    bool *marcado; // Marcas usadas na análise de conflitos
+    vetor_int aprendida;
+    int lbd_aprendida;
+    int *carimbo; // Por nível: último conflito que o contou no LBD
+    int conflitos;
+    bool inconsistente; // A fórmula tem cláusula vazia ou unitárias contraditórias
+    configuracao cfg;
+    unsigned long long sorteio; // Estado do gerador pseudoaleatório (xorshift)
+    portfolio *portfolio; // NULL fora do modo portfólio
+    int id; // Número da thread no portfólio
+}solver;
+
+unsigned long long sortear (solver *S){
+    S->sorteio ^= S->sorteio >> 12;
+    S->sorteio ^= S->sorteio << 25;
+    S->sorteio ^= S->sorteio >> 27;
+    return S->sorteio * 2685821657736338717ULL;
+}
+
+int valor_literal (solver *S, int lit){
+    int v = S->valor[VAR(lit)];
+    if (v == INDEFINIDO){
+        return INDEFINIDO;
+    }
+    return lit > 0 ? v : !v;
+}
+
+//------- Heap de atividade (máximo no topo) -------
+void heap_subir (solver *S, int i){
+    int var = S->heap[i];
+    while (i > 0 && S->atividade[S->heap[(i - 1) / 2]] < S->atividade[var]){
+        S->heap[i] = S->heap[(i - 1) / 2];
+        S->pos_heap[S->heap[i]] = i;
+        i = (i - 1) / 2;
+    }
+    S->heap[i] = var;
+    S->pos_heap[var] = i;
+}
+
+void heap_descer (solver *S, int i){
+    int var = S->heap[i];
+    while (2 * i + 1 < S->tam_heap){
+        int filho = 2 * i + 1;
+        if (filho + 1 < S->tam_heap && S->atividade[S->heap[filho + 1]] > S->atividade[S->heap[filho]]){
+            filho++;
+        }
+        if (S->atividade[S->heap[filho]] <= S->atividade[var]){
+            break;
+        }
+        S->heap[i] = S->heap[filho];
+        S->pos_heap[S->heap[i]] = i;
+        i = filho;
+    }
+    S->heap[i] = var;
+    S->pos_heap[var] = i;
+}
+
+void heap_inserir (solver *S, int var){
+    if (S->pos_heap[var] >= 0){
+        return;
+    }
+    S->heap[S->tam_heap] = var;
+    S->pos_heap[var] = S->tam_heap++;
+    heap_subir(S, S->tam_heap - 1);
+}
+
+int heap_remover (solver *S){
+    int topo = S->heap[0];
+    S->pos_heap[topo] = -1;
+    S->tam_heap--;
+    if (S->tam_heap > 0){
+        S->heap[0] = S->heap[S->tam_heap];
+        S->pos_heap[S->heap[0]] = 0;
+        heap_descer(S, 0);
+    }
+    return topo;
+}
+
+void aumentar_atividade (solver *S, int var){
+    S->atividade[var] += S->incremento;
+    if (S->atividade[var] > 1e100){ // Reescala tudo antes de estourar o double
+        for (int i = 0; i < S->num_variaveis; i++){
+            S->atividade[i] *= 1e-100;
+        }
+        S->incremento *= 1e-100;
+    }
+    if (S->pos_heap[var] >= 0){
+        heap_subir(S, S->pos_heap[var]);
+    }
+}
+
+//------- Atribuição e retrocesso -------
+void atribuir (solver *S, int lit, int razao){
+    int var = VAR(lit);
+    S->valor[var] = lit > 0;
+    S->nivel[var] = S->limites.tam;
+    S->razao[var] = razao;
+    S->trilha[S->tam_trilha++] = lit;
+}
+
+void retroceder (solver *S, int nivel){ // Desfaz as atribuições acima do nível pedido
+    if (S->limites.tam <= nivel){
+        return;
+    }
+    int inicio = S->limites.dados[nivel];
+    for (int i = S->tam_trilha - 1; i >= inicio; i--){
+        int var = VAR(S->trilha[i]);
+        S->fase[var] = S->valor[var];
+        S->valor[var] = INDEFINIDO;
+        heap_inserir(S, var);
+    }
+    S->tam_trilha = inicio;
+    S->propagados = inicio;
+    S->limites.tam = nivel;
+}
+
+//------- Cláusulas -------
+int nova_clausula (solver *S, int *lits, int tam, int lbd){ // Copia a cláusula para o banco e observa seus dois primeiros literais
+    int inicio = S->banco.literais.tam;
+    for (int k = 0; k < tam; k++){
+        empilhar(&S->banco.literais, lits[k]);
+    }
+    fechar_clausula(&S->banco, inicio);
+    empilhar(&S->lbd, lbd);
+    int c = S->banco.inicio.tam - 1;
+    empilhar(&S->observadores[IDX(lits[0])], c);
+    empilhar(&S->observadores[IDX(lits[1])], c);
+    return c;
+}
+
+void adicionar_clausula_original (solver *S, int *lt, int tam, bool *visto, vetor_int *temp){
+    if (S->inconsistente){
+        return;
+    }
+    temp->tam = 0;
+    bool tautologia = false;
+    for (int k = 0; k < tam; k++){ // Remove literais repetidos e descarta tautologias
+        if (visto[IDX(-lt[k])]){
+            tautologia = true;
+        }
+        if (!visto[IDX(lt[k])]){
+            visto[IDX(lt[k])] = true;
+            empilhar(temp, lt[k]);
+        }
+    }
+    for (int i = 0; i < temp->tam; i++){
+        visto[IDX(temp->dados[i])] = false;
+    }
+
+    if (tautologia){
+        return;
+    }
+    if (temp->tam == 0){
+        S->inconsistente = true;
+    }
+    else if (temp->tam == 1){ // Cláusula unitária: atribui direto no nível 0
+        int v = valor_literal(S, temp->dados[0]);
+        if (v == 0){
+            S->inconsistente = true;
+        }
+        else if (v == INDEFINIDO){
+            atribuir(S, temp->dados[0], -1);
+        }
+    }
+    else {
+        nova_clausula(S, temp->dados, temp->tam, 0);
+    }
+}
+
+solver *criar_solver (formula *F, const configuracao *cfg){ // cfg NULL: PADRAO
+    solver *S = (solver*)calloc(1, sizeof(solver));
+    S->cfg = cfg ? *cfg : PADRAO;
+    S->sorteio = S->cfg.semente * 0x9E3779B97F4A7C15ULL + 1;
+    int n = F->num_variaveis;
+    S->num_variaveis = n;
+    S->observadores = (vetor_int*)calloc(2 * n + 1, sizeof(vetor_int));
+    S->valor = (signed char*)malloc(n + 1);
+    S->fase = (signed char*)calloc(n + 1, 1);
+    if (S->cfg.fase_verdadeira){
+        memset(S->fase, 1, n + 1);
+    }
+    S->nivel = (int*)calloc(n + 1, sizeof(int));
+    S->razao = (int*)calloc(n + 1, sizeof(int));
+    S->trilha = (int*)malloc((n + 1) * sizeof(int));
+    S->atividade = (double*)calloc(n + 1, sizeof(double));
+    S->heap = (int*)malloc((n + 1) * sizeof(int));
+    S->pos_heap = (int*)malloc((n + 1) * sizeof(int));
+    S->marcado = (bool*)calloc(n + 1, sizeof(bool));
+    S->carimbo = (int*)calloc(n + 2, sizeof(int));
+    S->incremento = 1.0;
+    memset(S->valor, INDEFINIDO, n + 1);
+
+    banco_clausulas *B = &F->clausulas;
+    reservar(&S->banco.literais, B->literais.tam);
+    reservar(&S->banco.inicio, B->inicio.tam);
+    reservar(&S->banco.tam, B->inicio.tam);
+    vetor_int temp = {NULL, 0, 0};
+    bool *visto = (bool*)calloc(2 * n + 1, sizeof(bool));
+    for (int c = 0; c < B->inicio.tam; c++){
+        adicionar_clausula_original(S, literais_clausula(B, c), B->tam.dados[c], visto, &temp);
+    }
+    free(visto);
+    free(temp.dados);
+    S->num_originais = S->banco.inicio.tam;
+
+    for (int i = 0; i < n; i++){
+        S->pos_heap[i] = -1;
+        if (S->cfg.semente){ // Pequeno ruído na atividade inicial: cada semente começa por outra ordem
+            S->atividade[i] = (sortear(S) % 1000) * 1e-6;
+        }
+        if (S->valor[i] == INDEFINIDO){
+            heap_inserir(S, i);
         }
     }
-    return F;
+    return S;
 }
-bool eh_sat (formula *F, bool *interpretacoes){ // Acessar os literais, os modificando e  a formula e atraibuindo a um array de booleanos
-    clausula *cl = F->inicio;
-    while (cl != NULL){  //Ver todas as cláusulas
-        node *lt = cl->literias; 
-        bool cl_sat = false; // Assumimos que ela não é sat até ser provado o contrário
-        while (lt != NULL){ // Ver os literias x1 x2 ....
-            int var = lt->item;
-            bool valor;
-            if (var > 0){ // Se  não tiver negado
-               valor = interpretacoes[var - 1] ; // Pegamos o valor no array de atribuição // Reolhar "interpretacoes[var - 1]""
+
+void liberar_solver (solver *S){
+    for (int i = 0; i < 2 * S->num_variaveis + 1; i++){
+        free(S->observadores[i].dados);
+    }
+    liberar_banco(&S->banco); free(S->lbd.dados); free(S->observadores); free(S->valor); free(S->fase);
+    free(S->nivel); free(S->razao); free(S->trilha); free(S->atividade);
+    free(S->heap); free(S->pos_heap); free(S->marcado); free(S->carimbo);
+    free(S->limites.dados); free(S->aprendida.dados);
+    free(S);
+}
+
+//------- Propagação unitária com dois literais observados -------
+int propagar (solver *S){ // Retorna a cláusula em conflito ou -1
+    while (S->propagados < S->tam_trilha){
+        int falso = -S->trilha[S->propagados++]; // Literal que acabou de ficar falso
+        vetor_int *obs = &S->observadores[IDX(falso)];
+        int i = 0, j = 0;
+        while (i < obs->tam){
+            int c = obs->dados[i++];
+            int *lits = literais_clausula(&S->banco, c);
+            if (lits[0] == falso){ // Deixa o literal falso na posição 1
+                lits[0] = lits[1];
+                lits[1] = falso;
             }
-            else { // Caso não
-                valor = !interpretacoes[-var - 1]; // Vamos negar o valor de atribuição
+            if (valor_literal(S, lits[0]) == 1){ // Cláusula já satisfeita
+                obs->dados[j++] = c;
+                continue;
             }
-            if (valor){ // Se o valor é verdadeiro
-                cl_sat = true;
-                break;
+            bool achou = false;
+            for (int k = 2; k < S->banco.tam.dados[c]; k++){ // Procura outro literal para observar
+                if (valor_literal(S, lits[k]) != 0){
+                    lits[1] = lits[k];
+                    lits[k] = falso;
+                    empilhar(&S->observadores[IDX(lits[1])], c);
+                    achou = true;
+                    break;
+                }
             }
-            lt = lt->next;
+            if (achou){
+                continue;
+            }
+            obs->dados[j++] = c;
+            if (valor_literal(S, lits[0]) == 0){ // Todos os literais são falsos: conflito
+                while (i < obs->tam){
+                    obs->dados[j++] = obs->dados[i++];
+                }
+                obs->tam = j;
+                return c;
+            }
+            atribuir(S, lits[0], c); // Cláusula unitária: lits[0] é implicado
         }
-        if(!cl_sat){ // Se a cláusula for falsa
-            return false;
+        obs->tam = j;
+    }
+    return -1;
+}
+
+//------- Análise de conflito (primeiro ponto de implicação única) -------
+int analisar (solver *S, int conflito){ // Preenche S->aprendida e retorna o nível do retrocesso
+    vetor_int *aprendida = &S->aprendida;
+    aprendida->tam = 0;
+    empilhar(aprendida, 0); // Posição reservada para o literal do nível atual
+    int pendentes = 0, lit = 0, indice = S->tam_trilha - 1;
+    int c = conflito;
+    do {
+        int *lits = literais_clausula(&S->banco, c);
+        for (int k = (lit == 0 ? 0 : 1); k < S->banco.tam.dados[c]; k++){ // Na razão, lits[0] é o próprio literal implicado
+            int q = lits[k];
+            int var = VAR(q);
+            if (!S->marcado[var] && S->nivel[var] > 0){
+                S->marcado[var] = true;
+                aumentar_atividade(S, var);
+                if (S->nivel[var] == S->limites.tam){
+                    pendentes++;
+                }
+                else {
+                    empilhar(aprendida, q);
+                }
+            }
+        }
+        while (!S->marcado[VAR(S->trilha[indice])]){ // Próximo literal marcado, de trás para frente
+            indice--;
+        }
+        lit = S->trilha[indice--];
+        c = S->razao[VAR(lit)];
+        S->marcado[VAR(lit)] = false;
+        pendentes--;
+    } while (pendentes > 0);
+    aprendida->dados[0] = -lit;
+
+    // Minimização: sai o literal cuja razão só tem literais já na cláusula ou do nível 0
+    int j = 1;
+    for (int k = 1; k < aprendida->tam; k++){
+        int var = VAR(aprendida->dados[k]);
+        int c = S->razao[var];
+        bool redundante = c >= 0;
+        for (int r = 1; redundante && r < S->banco.tam.dados[c]; r++){
+            int v = VAR(literais_clausula(&S->banco, c)[r]);
+            redundante = S->marcado[v] || S->nivel[v] == 0;
+        }
+        if (!redundante){ // Troca em vez de sobrescrever: as removidas vão para o fim, onde ainda são desmarcadas
+            int t = aprendida->dados[j];
+            aprendida->dados[j++] = aprendida->dados[k];
+            aprendida->dados[k] = t;
         }
-        cl = cl->next;
     }
-    return true;
+    for (int k = j; k < aprendida->tam; k++){
+        S->marcado[VAR(aprendida->dados[k])] = false;
+    }
+    aprendida->tam = j;
+
+    S->conflitos++; // LBD: quantos níveis de decisão distintos a cláusula toca
+    S->lbd_aprendida = 0;
+    for (int k = 0; k < aprendida->tam; k++){
+        int nv = S->nivel[VAR(aprendida->dados[k])];
+        if (S->carimbo[nv] != S->conflitos){
+            S->carimbo[nv] = S->conflitos;
+            S->lbd_aprendida++;
+        }
+    }
+
+    int nivel = 0, maior = 1; // O literal de maior nível (abaixo do atual) fica na posição 1, para ser observado
+    for (int k = 1; k < aprendida->tam; k++){
+        S->marcado[VAR(aprendida->dados[k])] = false;
+        if (S->nivel[VAR(aprendida->dados[k])] > nivel){
+            nivel = S->nivel[VAR(aprendida->dados[k])];
+            maior = k;
+        }
+    }
+    if (aprendida->tam > 1){
+        int t = aprendida->dados[1];
+        aprendida->dados[1] = aprendida->dados[maior];
+        aprendida->dados[maior] = t;
+    }
+    S->incremento /= S->cfg.decaimento; // Decaimento do VSIDS
+    return nivel;
+}
+
+//------- Limpeza das cláusulas aprendidas -------
+typedef struct candidata{
+    int lbd;
+    int tam;
+    int c;
+}candidata;
+
+int comparar_lbd (const void *a, const void *b){
+    const candidata *x = (const candidata*)a, *y = (const candidata*)b;
+    if (x->lbd != y->lbd){
+        return x->lbd - y->lbd;
+    }
+    return x->tam - y->tam;
+}
+
+bool travada (solver *S, int c){ // A cláusula é a razão de uma atribuição atual
+    int var = VAR(literais_clausula(&S->banco, c)[0]);
+    return S->valor[var] != INDEFINIDO && S->razao[var] == c;
+}
+
+void reduzir_aprendidas (solver *S){ // Remove a pior metade das aprendidas (maior LBD), mantendo as de LBD <= 2
+    banco_clausulas *B = &S->banco;
+    candidata *ordem = (candidata*)malloc((B->inicio.tam - S->num_originais + 1) * sizeof(candidata));
+    int n = 0;
+    for (int c = S->num_originais; c < B->inicio.tam; c++){
+        if (B->tam.dados[c] > 0){ // Tamanho 0 marca as já removidas
+            ordem[n].lbd = S->lbd.dados[c];
+            ordem[n].tam = B->tam.dados[c];
+            ordem[n++].c = c;
+        }
+    }
+    qsort(ordem, n, sizeof(candidata), comparar_lbd);
+    for (int i = n / 2; i < n; i++){
+        if (ordem[i].lbd > 2 && !travada(S, ordem[i].c)){
+            B->tam.dados[ordem[i].c] = 0;
+        }
+    }
+    free(ordem);
+
+    // Compacta as aprendidas que sobraram; as posições crescem com o índice, então basta mover para trás
+    int destino = S->num_originais < B->inicio.tam ? B->inicio.dados[S->num_originais] : B->literais.tam;
+    for (int c = S->num_originais; c < B->inicio.tam; c++){
+        int tam = B->tam.dados[c];
+        memmove(B->literais.dados + destino, literais_clausula(B, c), tam * sizeof(int));
+        B->inicio.dados[c] = destino;
+        destino += tam;
+    }
+    B->literais.tam = destino;
+
+    for (int l = 0; l < 2 * S->num_variaveis; l++){ // Tira as removidas das listas de observadores
+        vetor_int *obs = &S->observadores[l];
+        int j = 0;
+        for (int i = 0; i < obs->tam; i++){
+            if (B->tam.dados[obs->dados[i]] > 0){
+                obs->dados[j++] = obs->dados[i];
+            }
+        }
+        obs->tam = j;
+    }
+}
+
+int luby (int i){ // i-ésimo termo (a partir de 0) da sequência 1 1 2 1 1 2 4 ...
+    int tam = 1, expoente = 0;
+    while (tam < i + 1){
+        tam = 2 * tam + 1;
+        expoente++;
+    }
+    while (tam - 1 != i){
+        tam = (tam - 1) / 2;
+        expoente--;
+        i = i % tam;
+    }
+    return 1 << expoente;
+}
+
+int proximo_limite (solver *S, int reinicios, int limite){ // Conflitos até o próximo reinício
+    if (S->cfg.reinicio == REINICIO_GEOMETRICO){
+        return limite < 1000000000 ? limite + limite / 2 : limite;
+    }
+    return S->cfg.unidade_reinicio * luby(reinicios);
+}
+
+//------- Troca de cláusulas entre as threads do portfólio -------
+void exportar_aprendida (solver *S){
+    portfolio *P = S->portfolio;
+    pthread_mutex_lock(&P->trava);
+    empilhar(&P->compartilhadas, S->aprendida.tam);
+    empilhar(&P->compartilhadas, S->lbd_aprendida);
+    empilhar(&P->compartilhadas, S->id);
+    for (int k = 0; k < S->aprendida.tam; k++){
+        empilhar(&P->compartilhadas, S->aprendida.dados[k]);
+    }
+    pthread_mutex_unlock(&P->trava);
+}
+
+void descartar_lidas (portfolio *P){ // Chamada com a trava: solta o prefixo que todas as threads já importaram
+    long long minimo = LLONG_MAX;
+    for (int i = 0; i < P->n_threads; i++){
+        if (P->lidas[i] < minimo){
+            minimo = P->lidas[i];
+        }
+    }
+    long long fim = P->base + P->compartilhadas.tam;
+    if (minimo > fim){ // Todas as threads já saíram
+        minimo = fim;
+    }
+    int descartar = minimo - P->base;
+    if (descartar > 0 && 2 * descartar >= P->compartilhadas.tam){ // Só move quando sobra no máximo a metade
+        memmove(P->compartilhadas.dados, P->compartilhadas.dados + descartar, (P->compartilhadas.tam - descartar) * sizeof(int));
+        P->compartilhadas.tam -= descartar;
+        P->base = minimo;
+    }
+}
+
+bool importar_compartilhadas (solver *S){ // Só no nível 0; retorna false se alguma cláusula ficou vazia (UNSAT)
+    portfolio *P = S->portfolio;
+    vetor_int novas = {NULL, 0, 0};
+    pthread_mutex_lock(&P->trava);
+    for (int i = P->lidas[S->id] - P->base; i < P->compartilhadas.tam; i++){
+        empilhar(&novas, P->compartilhadas.dados[i]);
+    }
+    P->lidas[S->id] = P->base + P->compartilhadas.tam;
+    descartar_lidas(P);
+    pthread_mutex_unlock(&P->trava);
+
+    bool ok = true;
+    for (int i = 0; ok && i < novas.tam; i += 3 + novas.dados[i]){
+        if (novas.dados[i + 2] == S->id){
+            continue;
+        }
+        // Tira os literais falsos no nível 0 e descarta a cláusula se algum já for verdadeiro
+        vetor_int *cl = &S->aprendida;
+        cl->tam = 0;
+        bool satisfeita = false;
+        for (int k = 0; k < novas.dados[i]; k++){
+            int lit = novas.dados[i + 3 + k];
+            int v = valor_literal(S, lit);
+            if (v == 1){
+                satisfeita = true;
+            }
+            else if (v == INDEFINIDO){
+                empilhar(cl, lit);
+            }
+        }
+        if (satisfeita){
+            continue;
+        }
+        if (cl->tam == 0){
+            ok = false;
+        }
+        else if (cl->tam == 1){
+            atribuir(S, cl->dados[0], -1);
+        }
+        else {
+            nova_clausula(S, cl->dados, cl->tam, novas.dados[i + 1]);
+        }
+    }
+    free(novas.dados);
+    return ok;
+}
+
+//------- Laço principal -------
+int CDCL (solver *S, bool *interpretacoes){ // 1 SAT, 0 UNSAT ou -1 se o portfólio mandou parar
+    if (S->inconsistente || propagar(S) >= 0){
+        return 0;
+    }
+    int reinicios = 0, conflitos_reinicio = 0;
+    int limite_reinicio = S->cfg.unidade_reinicio, proxima_limpeza = 2000;
+    for (;;){
+        if (S->portfolio && atomic_load_explicit(&S->portfolio->parar, memory_order_relaxed)){
+            return -1;
+        }
+        int conflito = propagar(S);
+        if (conflito >= 0){
+            conflitos_reinicio++;
+            if (S->limites.tam == 0){ // Conflito sem decisões: UNSAT
+                return 0;
+            }
+            int nivel = analisar(S, conflito);
+            retroceder(S, nivel); // Salto não cronológico
+            if (S->aprendida.tam == 1){
+                atribuir(S, S->aprendida.dados[0], -1);
+            }
+            else {
+                int c = nova_clausula(S, S->aprendida.dados, S->aprendida.tam, S->lbd_aprendida);
+                atribuir(S, S->aprendida.dados[0], c);
+            }
+            if (S->portfolio && S->aprendida.tam <= TAM_MAX_COMPARTILHADA && S->lbd_aprendida <= LBD_MAX_COMPARTILHADA){
+                exportar_aprendida(S);
+            }
+            continue;
+        }
+
+        if (conflitos_reinicio >= limite_reinicio){ // Reinício: volta ao nível 0 mantendo o aprendido
+            retroceder(S, 0);
+            conflitos_reinicio = 0;
+            limite_reinicio = proximo_limite(S, ++reinicios, limite_reinicio);
+            if (S->portfolio && !importar_compartilhadas(S)){
+                return 0;
+            }
+            continue;
+        }
+        if (S->conflitos >= proxima_limpeza){
+            reduzir_aprendidas(S);
+            proxima_limpeza = S->conflitos + 2000 + 300 * (proxima_limpeza / 2000);
+        }
+
+        int var = -1;
+        if (S->cfg.frequencia_aleatoria > 0 && S->tam_heap > 0 &&
+            sortear(S) % 1000000 < S->cfg.frequencia_aleatoria * 1000000){ // Decisão sorteada (fica no heap)
+            int v = S->heap[sortear(S) % S->tam_heap];
+            if (S->valor[v] == INDEFINIDO){
+                var = v;
+            }
+        }
+        while (var < 0 && S->tam_heap > 0){ // Variável livre mais ativa
+            var = heap_remover(S);
+            if (S->valor[var] != INDEFINIDO){
+                var = -1;
+            }
+        }
+        if (var < 0){ // Todas atribuídas sem conflito: SAT
+            for (int i = 0; i < S->num_variaveis; i++){
+                interpretacoes[i] = S->valor[i] == 1;
+            }
+            return 1;
+        }
+        empilhar(&S->limites, S->tam_trilha);
+        atribuir(S, S->fase[var] == 1 ? var + 1 : -(var + 1), -1);
+    }
+}
+//---------Portfólio paralelo-----------
+// N solvers CDCL independentes sobre a mesma fórmula, cada um com outros parâmetros; o primeiro a responder vence
+configuracao configuracao_portfolio (int id){ // A thread 0 usa os parâmetros do solver sequencial (mas também importa cláusulas); as outras variam
+    configuracao cfg = PADRAO;
+    if (id == 0){
+        return cfg;
+    }
+    const double decaimentos[] = {0.95, 0.85, 0.99, 0.90};
+    cfg.semente = id;
+    cfg.decaimento = decaimentos[id % 4];
+    cfg.reinicio = id % 2 ? REINICIO_GEOMETRICO : REINICIO_LUBY;
+    cfg.unidade_reinicio = id % 3 == 0 ? 512 : 100;
+    cfg.frequencia_aleatoria = (id % 5) * 0.005;
+    cfg.fase_verdadeira = id % 4 >= 2;
+    return cfg;
+}
+
+int numero_processadores (){
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
 }
-bool SAT_SOLVER (tree *root, formula *F, bool *interpretacoes, int nivel){
-    if (root == NULL){
-        return eh_sat(F, interpretacoes);
+
+typedef struct trabalho_portfolio{
+    portfolio *P;
+    int id;
+}trabalho_portfolio;
+
+void *trabalhar_portfolio (void *arg){
+    trabalho_portfolio *T = (trabalho_portfolio*)arg;
+    portfolio *P = T->P;
+    configuracao cfg = configuracao_portfolio(T->id);
+    solver *S = criar_solver(P->F, &cfg);
+    S->portfolio = P;
+    S->id = T->id;
+    bool *interpretacao = (bool*)malloc((P->F->num_variaveis + 1) * sizeof(bool));
+
+    int resultado = CDCL(S, interpretacao);
+    if (resultado >= 0){
+        pthread_mutex_lock(&P->trava);
+        if (P->resultado < 0){
+            P->resultado = resultado;
+            P->vencedora = T->id;
+            memcpy(P->interpretacao, interpretacao, P->F->num_variaveis * sizeof(bool));
+        }
+        pthread_mutex_unlock(&P->trava);
+        atomic_store(&P->parar, 1); // Cancela as demais
     }
-    interpretacoes[nivel] = true ; // True para a variavel atual
-    if(SAT_SOLVER(root->esquerda, F, interpretacoes, nivel + 1)){
-        return true;
+    pthread_mutex_lock(&P->trava);
+    P->lidas[T->id] = LLONG_MAX; // Não segura mais o descarte das cláusulas compartilhadas
+    pthread_mutex_unlock(&P->trava);
+    free(interpretacao);
+    liberar_solver(S);
+    return NULL;
+}
+
+bool resolver_portfolio (formula *F, int n_threads, bool *interpretacoes){
+    portfolio P;
+    memset(&P, 0, sizeof(portfolio));
+    P.F = F;
+    P.resultado = -1;
+    P.interpretacao = interpretacoes;
+    P.n_threads = n_threads;
+    P.lidas = (long long*)calloc(n_threads, sizeof(long long));
+    atomic_init(&P.parar, 0);
+    pthread_mutex_init(&P.trava, NULL);
+
+    pthread_t *threads = (pthread_t*)malloc(n_threads * sizeof(pthread_t));
+    trabalho_portfolio *trabalhos = (trabalho_portfolio*)malloc(n_threads * sizeof(trabalho_portfolio));
+    int criadas = 0;
+    for (int i = 0; i < n_threads; i++){
+        trabalhos[i].P = &P;
+        trabalhos[i].id = i;
+        if (pthread_create(&threads[criadas], NULL, trabalhar_portfolio, &trabalhos[i]) != 0){
+            break; // Segue com as threads que conseguiu criar
+        }
+        criadas++;
     }
-    interpretacoes[nivel] = false;
-    if (SAT_SOLVER(root->direita, F, interpretacoes, nivel + 1)){
-        return true;
+    pthread_mutex_lock(&P.trava);
+    for (int i = criadas; i < n_threads; i++){ // Threads que não foram criadas não seguram o descarte
+        P.lidas[i] = LLONG_MAX;
     }
-    return false ;
+    pthread_mutex_unlock(&P.trava);
+    if (criadas == 0){
+        P.lidas[0] = 0;
+        trabalhar_portfolio(&trabalhos[0]);
+    }
+    for (int i = 0; i < criadas; i++){
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&P.trava);
+    free(P.compartilhadas.dados);
+    free(P.lidas);
+    free(threads);
+    free(trabalhos);
+    return P.resultado == 1;
 }
 void solucao (bool *interpretacao, int num_var){
     printf("SAT !\n");
@@ -163,24 +1096,70 @@ void solucao (bool *interpretacao, int num_var){
         printf("x%d = %s\n", i + 1, interpretacao[i] ? "TRUE" : "FALSE");
     }
 }
-int main (){
-    FILE *fp = fopen("teste6.cnf", "r");
-    if (fp == NULL){
+int main (int argc, char *argv[]){
+    bool forca_bruta = false; // -b: enumera todas as atribuições, como antes
+    int n_threads = 0; // -p N: portfólio com N threads (0 usa todos os processadores)
+    bool paralelo = false;
+    const char *caminho = NULL;
+    bool uso_invalido = false;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "-b") == 0){
+            forca_bruta = true;
+        }
+        else if (strcmp(argv[i], "-p") == 0){
+            char *fim;
+            if (i + 1 >= argc || (n_threads = strtol(argv[++i], &fim, 10)) < 0 || *fim != '\0'){
+                uso_invalido = true;
+            }
+            paralelo = true;
+        }
+        else {
+            caminho = argv[i];
+        }
+    }
+    if (caminho == NULL || uso_invalido || (forca_bruta && paralelo)){
+        printf("Uso: %s [-b | -p threads] arquivo.cnf\n", argv[0]);
+        return 1;
+    }
+    if (paralelo && n_threads == 0){
+        n_threads = numero_processadores();
+    }
+
+    arquivo_cnf A;
+    if (!abrir_cnf(caminho, &A)){
         printf("Erro ao abrir o arquivo.\n");
         return 1;
     }
-    formula F = read_formula(fp);
-    fclose(fp);
+    formula F;
+    bool lido = read_formula(A.dados, A.tam, &F);
+    fechar_cnf(&A);
+    if (!lido){
+        printf("Arquivo .cnf invalido.\n");
+        liberar_banco(&F.clausulas);
+        return 1;
+    }
 
-    tree *root = creat_binary_tree(1, F.num_variaveis);
     bool *interpretacao = (bool*)malloc(F.num_variaveis * sizeof(bool));
+    bool sat;
+    if (forca_bruta){
+        sat = SAT_SOLVER(&F, interpretacao);
+    }
+    else if (paralelo){
+        sat = resolver_portfolio(&F, n_threads, interpretacao);
+    }
+    else {
+        solver *S = criar_solver(&F, NULL);
+        sat = CDCL(S, interpretacao) == 1;
+        liberar_solver(S);
+    }
 
-    if (SAT_SOLVER(root, &F, interpretacao, 0)){
+    if (sat){
         solucao(interpretacao, F.num_variaveis);
     }
     else {
         printf("UNSAT!\n");
     }
+    liberar_banco(&F.clausulas);
     free(interpretacao);
     return 0;
 }